@@ -0,0 +1,49 @@
+#include <apic.h>
+#include <defs.h>
+
+#define ICR_DELIVERY_PENDING (1 << 12)
+
+// Pure64 leaves the address of the Local APIC here (os_LocalAPICAddress), or 0 if there is none.
+static uint64_t *const localApicAddressVariable = (uint64_t *) 0x5A28;
+
+static volatile uint32_t *localApic = NULL;
+
+int
+initializeLocalApic() {
+    localApic = (volatile uint32_t *) *localApicAddressVariable;
+    return localApic != NULL;
+}
+
+int
+hasLocalApic() {
+    return localApic != NULL;
+}
+
+uint32_t
+readLocalApic(uint32_t reg) {
+    return localApic[reg / sizeof(uint32_t)];
+}
+
+void
+writeLocalApic(uint32_t reg, uint32_t value) {
+    localApic[reg / sizeof(uint32_t)] = value;
+}
+
+uint8_t
+getLocalApicId() {
+    return readLocalApic(LAPIC_ID) >> 24;
+}
+
+void
+acknowledgeLocalApic() {
+    writeLocalApic(LAPIC_EOI, 0);
+}
+
+void
+sendIpi(uint8_t apicId, uint8_t vector) {
+    writeLocalApic(LAPIC_ICR_HIGH, (uint32_t) apicId << 24);
+    writeLocalApic(LAPIC_ICR_LOW, vector);
+
+    while (readLocalApic(LAPIC_ICR_LOW) & ICR_DELIVERY_PENDING)
+        ;
+}
@@ -0,0 +1,26 @@
+GLOBAL saveFpuState
+GLOBAL restoreFpuState
+GLOBAL setTaskSwitched
+GLOBAL clearTaskSwitched
+
+section .text
+
+; Both take a 16-byte aligned, 512-byte area
+saveFpuState:
+	fxsave64 [rdi]
+	ret
+
+restoreFpuState:
+	fxrstor64 [rdi]
+	ret
+
+; Makes the next FPU/SSE instruction raise #NM (CR0.TS, bit 3)
+setTaskSwitched:
+	mov rax, cr0
+	bts rax, 3
+	mov cr0, rax
+	ret
+
+clearTaskSwitched:
+	clts
+	ret
@@ -14,6 +14,7 @@ GLOBAL irq04Handler
 GLOBAL irq05Handler
 GLOBAL exception0Handler
 GLOBAL exception6Handler
+GLOBAL exception7Handler
 GLOBAL exception0DHandler
 GLOBAL exception0EHandler
 
@@ -25,7 +26,9 @@ GLOBAL syscallHandler
 EXTERN irqDispatcher
 EXTERN syscallDispatcher
 EXTERN exceptionDispatcher
+EXTERN deviceNotAvailableHandler
 EXTERN switchProcess
+EXTERN rescheduleFromInterrupt
 
 SECTION .text
 
@@ -74,6 +77,10 @@ SECTION .text
 	mov al, 20h
 	out 20h, al
 
+	mov rdi, rsp
+	call rescheduleFromInterrupt
+	mov rsp, rax
+
 	popState
 	iretq
 %endmacro
@@ -157,6 +164,13 @@ exception0Handler:
 exception6Handler:
 	exceptionHandler 06h
 
+; Device Not Available Exception, raised by the first FPU/SSE instruction after a context switch
+exception7Handler:
+	pushState
+	call deviceNotAvailableHandler
+	popState
+	iretq
+
 ; General Protection Exception
 exception0DHandler:
 	exceptionHandler 0Dh
@@ -0,0 +1,23 @@
+GLOBAL outb
+GLOBAL inb
+GLOBAL readTimestampCounter
+
+section .text
+
+outb:
+	mov dx, di
+	mov al, sil
+	out dx, al
+	ret
+
+inb:
+	mov dx, di
+	xor eax, eax
+	in al, dx
+	ret
+
+readTimestampCounter:
+	rdtsc
+	shl rdx, 32
+	or rax, rdx
+	ret
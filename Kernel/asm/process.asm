@@ -9,6 +9,7 @@ createProcessStack:
     push rbp
     mov rbp, rsp
     
+    and rdx, -16            ; The SysV ABI expects a 16-byte aligned stack, which SSE code relies on
     mov rsp, rdx
     push 0x0
     push rdx
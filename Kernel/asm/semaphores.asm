@@ -6,7 +6,13 @@ spinLock:
   mov al, 1
   xchg al, [rdi]
   cmp al, 0
-  jne spinLock
+  je .acquired
+.wait:
+  pause               ; Spin on plain reads so the cache line is not bounced between CPUs
+  cmp byte [rdi], 0
+  jne .wait
+  jmp spinLock
+.acquired:
   ret
 
 unlock:
@@ -0,0 +1,31 @@
+GLOBAL apStartHandler
+GLOBAL setCpuBase
+
+EXTERN getApStack
+EXTERN apMain
+
+IA32_GS_BASE equ 0xC0000101
+
+section .text
+
+; Raised by the BSP on each AP parked by Pure64. Moves the AP onto its own kernel stack and never returns, so nothing
+; of the interrupted context needs to be kept. An AP the kernel does not know is parked right away.
+apStartHandler:
+	call getApStack
+	test rax, rax
+	jz .park
+	mov rsp, rax
+	call apMain
+.park:
+	cli
+	hlt
+	jmp .park
+
+; Points the GS base of the calling CPU to its per-CPU data
+setCpuBase:
+	mov rax, rdi
+	mov rdx, rdi
+	shr rdx, 32
+	mov ecx, IA32_GS_BASE
+	wrmsr
+	ret
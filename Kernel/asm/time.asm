@@ -1,4 +1,6 @@
 GLOBAL readValue
+GLOBAL setTimerCounter
+GLOBAL getTimerCounter
 
 section .text
 
@@ -6,4 +8,24 @@ readValue:
 	mov al, dil
 	out 70h, al
 	in al, 71h
-	ret
\ No newline at end of file
+	ret
+
+; Programs channel 0 of the PIT with the mode in dil and the reload value in si (0 stands for 65536)
+setTimerCounter:
+	mov al, dil
+	out 43h, al
+	mov ax, si
+	out 40h, al
+	mov al, ah
+	out 40h, al
+	ret
+
+; Latches and reads the current count of channel 0 of the PIT
+getTimerCounter:
+	xor eax, eax
+	out 43h, al
+	in al, 40h
+	mov ah, al
+	in al, 40h
+	xchg al, ah
+	ret
@@ -0,0 +1,121 @@
+#include <defs.h>
+#include <fpu.h>
+#include <lib.h>
+#include <memoryManager.h>
+#include <process.h>
+#include <scheduler.h>
+
+/*
+ * Lazy FPU/SSE context switching. The registers stay loaded with the state of their owner, and CR0.TS is set
+ * whenever another process runs, so only processes that actually use them pay for FXSAVE/FXRSTOR.
+ */
+#define FPU_STATE_SIZE      512
+#define FPU_STATE_ALIGNMENT 16
+
+// Offsets into the FXSAVE area and their values after FNINIT
+#define FCW_OFFSET    0
+#define MXCSR_OFFSET  24
+#define DEFAULT_FCW   0x037F
+#define DEFAULT_MXCSR 0x1F80
+
+#define NO_OWNER -1
+
+extern void saveFpuState(void *area);
+extern void restoreFpuState(void *area);
+extern void setTaskSwitched();
+extern void clearTaskSwitched();
+
+static void **states = NULL;
+static unsigned int statesSize = 0;
+static Pid owner;
+static int taskSwitched;
+
+static void *
+getFpuState(Pid pid) {
+    size_t area = (size_t) states[PID_TO_SLOT(pid)];
+    return (void *) ((area + FPU_STATE_ALIGNMENT - 1) & ~(size_t) (FPU_STATE_ALIGNMENT - 1));
+}
+
+void
+initializeFpu() {
+    owner = NO_OWNER;
+    taskSwitched = 0;
+}
+
+int
+resizeFpuStates(unsigned int size) {
+    if (size <= statesSize)
+        return 0;
+
+    void **newStates = realloc(states, size * sizeof(void *));
+    if (newStates == NULL)
+        return 1;
+
+    for (unsigned int i = statesSize; i < size; i++)
+        newStates[i] = NULL;
+
+    states = newStates;
+    statesSize = size;
+    return 0;
+}
+
+int
+resetFpuState(Pid pid) {
+    if (pid < 0 || PID_TO_SLOT(pid) >= statesSize)
+        return 1;
+
+    // Areas are kept when a process dies and reused by the next one in the same slot.
+    void **area = &states[PID_TO_SLOT(pid)];
+    if (*area == NULL && (*area = malloc(FPU_STATE_SIZE + FPU_STATE_ALIGNMENT - 1)) == NULL)
+        return 1;
+
+    uint8_t *state = getFpuState(pid);
+    memset(state, 0, FPU_STATE_SIZE);
+    *(uint16_t *) (state + FCW_OFFSET) = DEFAULT_FCW;
+    *(uint32_t *) (state + MXCSR_OFFSET) = DEFAULT_MXCSR;
+
+    // An owner left in the slot by an earlier generation would otherwise save its registers over the fresh state.
+    if (owner != NO_OWNER && PID_TO_SLOT(owner) == PID_TO_SLOT(pid))
+        owner = NO_OWNER;
+    return 0;
+}
+
+void
+releaseFpuState(Pid pid) {
+    if (owner == pid)
+        owner = NO_OWNER;
+}
+
+void
+onFpuSwitch(Pid pid) {
+    int shouldTrap = pid != owner;
+    if (shouldTrap == taskSwitched)
+        return;
+
+    // Writing CR0 serializes the CPU, so only do it when TS actually changes.
+    if (shouldTrap)
+        setTaskSwitched();
+    else
+        clearTaskSwitched();
+    taskSwitched = shouldTrap;
+}
+
+void
+deviceNotAvailableHandler() {
+    clearTaskSwitched();
+    taskSwitched = 0;
+
+    Pid pid = getpid();
+    if (pid == owner)
+        return;
+
+    if (owner != NO_OWNER)
+        saveFpuState(getFpuState(owner));
+
+    if (pid >= 0 && PID_TO_SLOT(pid) < statesSize && states[PID_TO_SLOT(pid)] != NULL) {
+        restoreFpuState(getFpuState(pid));
+        owner = pid;
+    } else {
+        owner = NO_OWNER;
+    }
+}
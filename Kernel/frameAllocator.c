@@ -0,0 +1,190 @@
+#include <defs.h>
+#include <frameAllocator.h>
+#include <lib.h>
+
+#define FRAME_ALIGN_DOWN(value) ((value) & ~((uint64_t) FRAME_SIZE - 1))
+#define FRAME_ALIGN_UP(value)   FRAME_ALIGN_DOWN((value) + FRAME_SIZE - 1)
+
+#define E820_MAX_ENTRIES 256
+#define E820_END         0
+#define E820_USABLE      1
+
+#define MAX_FRAME_RANGES 64
+
+// Real mode IVT, BIOS data, Pure64 itself, its page tables, the E820 map, the infomap and the AP stacks.
+#define BOOT_MEMORY_END 0x100000
+
+// Pure64 identity maps the first 64 GiB.
+#define MAPPED_MEMORY_END 0x1000000000UL
+
+// If the BIOS gave no memory map, assume the 32 MiB the kernel always ran in.
+#define FALLBACK_MEMORY_END 0x2000000
+
+// Entry of the E820 map, which Pure64 stores padded to 32 bytes and terminates with an entry of type 0.
+typedef struct {
+    uint64_t base;
+    uint64_t length;
+    uint32_t type;
+    uint32_t attributes;
+    uint64_t padding;
+} __attribute__((packed)) E820Entry;
+
+typedef struct {
+    uint64_t start;
+    uint64_t end;
+} FrameRange;
+
+static const E820Entry *const e820Map = (E820Entry *) 0x4000;
+
+static FrameRange ranges[MAX_FRAME_RANGES];
+static unsigned int rangeCount;
+
+static void
+removeRangeAt(unsigned int i) {
+    rangeCount--;
+    for (; i < rangeCount; i++)
+        ranges[i] = ranges[i + 1];
+}
+
+static void
+insertRangeAt(unsigned int i, uint64_t start, uint64_t end) {
+    for (unsigned int j = rangeCount; j > i; j--)
+        ranges[j] = ranges[j - 1];
+    ranges[i].start = start;
+    ranges[i].end = end;
+    rangeCount++;
+}
+
+// Adds a free range, merging it with the ranges it overlaps or touches.
+static void
+addRange(uint64_t start, uint64_t end) {
+    start = FRAME_ALIGN_UP(start);
+    end = FRAME_ALIGN_DOWN(end);
+    if (start >= end)
+        return;
+
+    unsigned int i = 0;
+    while (i < rangeCount && ranges[i].end < start)
+        i++;
+
+    if (i == rangeCount || ranges[i].start > end) {
+        if (rangeCount < MAX_FRAME_RANGES)
+            insertRangeAt(i, start, end);
+        return;
+    }
+
+    if (start < ranges[i].start)
+        ranges[i].start = start;
+    if (end > ranges[i].end)
+        ranges[i].end = end;
+
+    while (i + 1 < rangeCount && ranges[i + 1].start <= ranges[i].end) {
+        if (ranges[i + 1].end > ranges[i].end)
+            ranges[i].end = ranges[i + 1].end;
+        removeRangeAt(i + 1);
+    }
+}
+
+// Cuts a segment out of the free ranges.
+static void
+removeRange(uint64_t start, uint64_t end) {
+    start = FRAME_ALIGN_DOWN(start);
+    end = FRAME_ALIGN_UP(end);
+
+    unsigned int i = 0;
+    while (i < rangeCount) {
+        FrameRange *range = &ranges[i];
+
+        if (range->end <= start || range->start >= end) {
+            i++;
+        } else if (range->start >= start && range->end <= end) {
+            removeRangeAt(i);
+        } else if (range->start < start && range->end > end) {
+            // The segment is in the middle of the range. Without room to split it, lose the upper part.
+            if (rangeCount < MAX_FRAME_RANGES)
+                insertRangeAt(i + 1, end, range->end);
+            range->end = start;
+            i += 2;
+        } else if (range->start < start) {
+            range->end = start;
+            i++;
+        } else {
+            range->start = end;
+            i++;
+        }
+    }
+}
+
+void
+initializeFrameAllocator() {
+    rangeCount = 0;
+
+    for (int i = 0; i < E820_MAX_ENTRIES && e820Map[i].type != E820_END; i++) {
+        const E820Entry *entry = &e820Map[i];
+        if (entry->type != E820_USABLE || entry->base >= MAPPED_MEMORY_END)
+            continue;
+
+        uint64_t end = entry->base + entry->length;
+        addRange(entry->base, end > MAPPED_MEMORY_END ? MAPPED_MEMORY_END : end);
+    }
+
+    if (rangeCount == 0)
+        addRange(BOOT_MEMORY_END, FALLBACK_MEMORY_END);
+
+    removeRange(0, BOOT_MEMORY_END);
+}
+
+void
+reserveFrames(void *start, size_t size) {
+    removeRange((uint64_t) start, (uint64_t) start + size);
+}
+
+void *
+allocateFrames(size_t count) {
+    uint64_t size = count * FRAME_SIZE;
+    if (size == 0)
+        return NULL;
+
+    for (unsigned int i = 0; i < rangeCount; i++) {
+        if (ranges[i].end - ranges[i].start < size)
+            continue;
+
+        void *frames = (void *) ranges[i].start;
+        ranges[i].start += size;
+        if (ranges[i].start == ranges[i].end)
+            removeRangeAt(i);
+        return frames;
+    }
+
+    return NULL;
+}
+
+void
+freeFrames(void *frames, size_t count) {
+    addRange((uint64_t) frames, (uint64_t) frames + count * FRAME_SIZE);
+}
+
+size_t
+takeFrameRange(void **start) {
+    if (rangeCount == 0)
+        return 0;
+
+    unsigned int largest = 0;
+    for (unsigned int i = 1; i < rangeCount; i++) {
+        if (ranges[i].end - ranges[i].start > ranges[largest].end - ranges[largest].start)
+            largest = i;
+    }
+
+    *start = (void *) ranges[largest].start;
+    size_t size = ranges[largest].end - ranges[largest].start;
+    removeRangeAt(largest);
+    return size;
+}
+
+size_t
+getFreeFrames() {
+    size_t frames = 0;
+    for (unsigned int i = 0; i < rangeCount; i++)
+        frames += (ranges[i].end - ranges[i].start) / FRAME_SIZE;
+    return frames;
+}
@@ -156,6 +156,12 @@ clearScreen() {
     current_j = 0;
 }
 
+void *
+getFramebuffer(size_t *size) {
+    *size = (size_t) graphicModeInfo->pitch * graphicModeInfo->height;
+    return (void *) (size_t) graphicModeInfo->framebuffer;
+}
+
 void
 printDec(uint64_t number) {
     printBase(number, 10);
@@ -0,0 +1,63 @@
+#ifndef _APIC_H_
+#define _APIC_H_
+
+#include <defs.h>
+
+/* --- Local APIC registers, as offsets from its base address --- */
+#define LAPIC_ID       0x020
+#define LAPIC_EOI      0x0B0
+#define LAPIC_ICR_LOW  0x300
+#define LAPIC_ICR_HIGH 0x310
+
+/**
+ * @brief Looks up the Local APIC the bootloader found. Every CPU sees its own Local APIC at the same address.
+ *
+ * @returns - 1 if there is a Local APIC, 0 otherwise.
+ */
+int initializeLocalApic();
+
+/**
+ * @brief Checks whether a Local APIC was found by initializeLocalApic().
+ *
+ * @returns - 1 if there is a Local APIC, 0 otherwise.
+ */
+int hasLocalApic();
+
+/**
+ * @brief Reads a register of the Local APIC of the calling CPU.
+ *
+ * @param reg Offset of the register.
+ *
+ * @returns - The value of the register.
+ */
+uint32_t readLocalApic(uint32_t reg);
+
+/**
+ * @brief Writes a register of the Local APIC of the calling CPU.
+ *
+ * @param reg Offset of the register.
+ * @param value The value to be written.
+ */
+void writeLocalApic(uint32_t reg, uint32_t value);
+
+/**
+ * @brief Gets the APIC ID of the calling CPU.
+ *
+ * @returns - The APIC ID.
+ */
+uint8_t getLocalApicId();
+
+/**
+ * @brief Signals the end of the interrupt being handled to the Local APIC of the calling CPU.
+ */
+void acknowledgeLocalApic();
+
+/**
+ * @brief Sends an inter-processor interrupt to another CPU and waits until it is delivered.
+ *
+ * @param apicId APIC ID of the destination CPU.
+ * @param vector Interrupt vector to raise on the destination CPU.
+ */
+void sendIpi(uint8_t apicId, uint8_t vector);
+
+#endif
@@ -72,7 +72,7 @@
 /**
  * @brief Represents the various categories of supported memory managers.
  */
-typedef enum { LIST, BUDDY } MemoryManagerType;
+typedef enum { LIST, BUDDY, TLSF } MemoryManagerType;
 
 /**
  * @brief Reflects the condition of the system memory at a specific moment.
@@ -95,10 +95,15 @@ typedef struct {
  */
 #define MAX_NAME_LENGTH 16
 
+/**
+ * @brief Amount of low bits of a Pid holding the process table slot. The remaining bits hold the slot generation.
+ */
+#define PID_SLOT_BITS 12
+
 /**
  * @brief Maximum amount of process living at the same time.
  */
-#define MAX_PROCESSES 8
+#define MAX_PROCESSES (1 << PID_SLOT_BITS)
 
 /**
  * @brief Represents a process id.
@@ -174,6 +179,13 @@ typedef struct {
     Priority priority;
     ProcessStatus status;
     void *currentRSP;
+    // Times in milliseconds, the first and last ones since startup
+    unsigned long startTime;
+    unsigned long cpuTime;
+    unsigned long waitTime;
+    unsigned long lastRunTime;
+    unsigned long voluntarySwitches;
+    unsigned long involuntarySwitches;
 } ProcessInfo;
 
 /**
@@ -233,6 +245,38 @@ typedef struct {
     char name[MAX_NAME_LENGTH + 1];
     Pid processesWQ[MAX_PID_ARRAY_LENGTH + 1];
 } SemaphoreInfo;
+
+/* --- Scheduler Trace --- */
+
+/**
+ * @brief Amount of events kept by the scheduler trace. Older events are overwritten.
+ */
+#define TRACE_BUFFER_SIZE 1024
+
+/**
+ * @brief Represents the kinds of events recorded by the scheduler trace.
+ */
+typedef enum {
+    TRACE_SWITCH_OUT = 0,
+    TRACE_SWITCH_IN = 1,
+    TRACE_BLOCK = 2,
+    TRACE_UNBLOCK = 3,
+    TRACE_FORCE_RUN = 4,
+    TRACE_CREATE = 5,
+    TRACE_KILL = 6,
+    TRACE_HAND_OFF = 7
+} TraceEventType;
+
+/**
+ * @brief Represents a scheduler event. The meaning of other depends on the type: 1 if the process was preempted for
+ * TRACE_SWITCH_OUT, the previous process for TRACE_SWITCH_IN, and the process that caused the event otherwise.
+ */
+typedef struct {
+    uint64_t timestamp;
+    TraceEventType type;
+    Pid pid;
+    Pid other;
+} TraceEvent;
 #endif
 
 /* --- Others --- */
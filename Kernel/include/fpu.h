@@ -0,0 +1,50 @@
+#ifndef _FPU_H_
+#define _FPU_H_
+
+#include <defs.h>
+
+/**
+ * @brief Initializes lazy FPU/SSE context switching. No process owns the FPU registers afterwards.
+ */
+void initializeFpu();
+
+/**
+ * @brief Makes room for the FPU/SSE state of processes living in process table slots below size.
+ *
+ * @param size Amount of process table slots.
+ *
+ * @returns - 0 if the operation is successful, 1 otherwise.
+ */
+int resizeFpuStates(unsigned int size);
+
+/**
+ * @brief Gives a newly created process a clean FPU/SSE state, as left by FNINIT.
+ *
+ * @param pid PID of the process.
+ *
+ * @returns - 0 if the operation is successful, 1 otherwise.
+ */
+int resetFpuState(Pid pid);
+
+/**
+ * @brief Forgets the FPU/SSE registers of a killed process, so they are not saved on the next switch.
+ *
+ * @param pid PID of the process.
+ */
+void releaseFpuState(Pid pid);
+
+/**
+ * @brief Invoked when a process is about to run. The registers are not switched here: unless the process is the one
+ * whose state is loaded, its first FPU/SSE instruction traps and the state is switched then.
+ *
+ * @param pid PID of the process.
+ */
+void onFpuSwitch(Pid pid);
+
+/**
+ * @brief Invoked on a Device Not Available exception (#NM). Saves the registers of their previous owner and loads
+ * those of the current process.
+ */
+void deviceNotAvailableHandler();
+
+#endif
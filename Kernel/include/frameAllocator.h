@@ -0,0 +1,64 @@
+#ifndef _FRAME_ALLOCATOR_H_
+#define _FRAME_ALLOCATOR_H_
+
+#include <defs.h>
+#include <stddef.h>
+
+/*
+ * Physical memory is handed out in page frames. The free frames are kept as a sorted list of ranges, built at boot
+ * from the E820 map Pure64 leaves behind and cut around everything that is already in use.
+ */
+
+/**
+ * @brief Size in bytes of a page frame.
+ */
+#define FRAME_SIZE 0x1000
+
+/**
+ * @brief Reads the E820 map and takes every usable range as free, except for the first MiB, which holds the boot
+ * structures. Ranges above the memory Pure64 identity maps are left out.
+ */
+void initializeFrameAllocator();
+
+/**
+ * @brief Marks the page frames that overlap a memory segment as used, so they are never handed out.
+ *
+ * @param start Start of the memory segment.
+ * @param size Size of the memory segment in bytes.
+ */
+void reserveFrames(void *start, size_t size);
+
+/**
+ * @brief Takes contiguous free page frames.
+ *
+ * @param count Amount of page frames.
+ *
+ * @returns - The address of the first page frame, or NULL if there is no free range that large.
+ */
+void *allocateFrames(size_t count);
+
+/**
+ * @brief Gives back page frames taken with allocateFrames().
+ *
+ * @param frames Address of the first page frame.
+ * @param count Amount of page frames.
+ */
+void freeFrames(void *frames, size_t count);
+
+/**
+ * @brief Takes the largest range of free page frames as a whole.
+ *
+ * @param start Out address of the first page frame of the range.
+ *
+ * @returns - The size of the range in bytes, or 0 if there are no free page frames left.
+ */
+size_t takeFrameRange(void **start);
+
+/**
+ * @brief Gets the amount of free page frames.
+ *
+ * @returns - The amount of free page frames.
+ */
+size_t getFreeFrames();
+
+#endif
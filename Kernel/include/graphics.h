@@ -27,6 +27,15 @@ void initializeScreen();
  */
 void clearScreen();
 
+/**
+ * @brief Gets where the framebuffer of the screen lives in memory.
+ *
+ * @param size Out size of the framebuffer in bytes.
+ *
+ * @returns - The address of the framebuffer.
+ */
+void *getFramebuffer(size_t *size);
+
 /**
  * @brief Prints line into screen.
  */
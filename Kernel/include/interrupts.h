@@ -39,9 +39,14 @@ void irq00Handler(void);
 void irq01Handler(void);
 void exception0Handler(void);
 void exception6Handler(void);
+void exception7Handler(void);
 void exception0DHandler(void);
 void exception0EHandler(void);
 
+/* --- Multiprocessor Handlers --- */
+
+void apStartHandler(void);
+
 /* --- Scheduler Handlers --- */
 
 void awakeScheduler(void);
@@ -55,4 +55,28 @@ uint32_t uintToBase(uint64_t value, char *buffer, uint32_t base);
  */
 uint8_t bcdToDec(uint8_t value);
 
+/**
+ * @brief Writes a byte to an I/O port.
+ *
+ * @param port The port to write to.
+ * @param value The byte to be written.
+ */
+void outb(uint16_t port, uint8_t value);
+
+/**
+ * @brief Reads a byte from an I/O port.
+ *
+ * @param port The port to read from.
+ *
+ * @returns - The byte read.
+ */
+uint8_t inb(uint16_t port);
+
+/**
+ * @brief Reads the processor's time-stamp counter.
+ *
+ * @returns - The amount of cycles elapsed since the processor was reset.
+ */
+uint64_t readTimestampCounter();
+
 #endif
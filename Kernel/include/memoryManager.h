@@ -12,6 +12,14 @@
  */
 void initializeMemory(void *memoryStart, size_t memorySize);
 
+/**
+ * @brief Hands another memory segment to the memory manager once it is initialized.
+ *
+ * @param memoryStart The initial location of the memory segment.
+ * @param memorySize The total number of bytes of the memory segment.
+ */
+void addMemory(void *memoryStart, size_t memorySize);
+
 /**
  * @brief Request the memory manager to reserve a chunk of memory.
  *
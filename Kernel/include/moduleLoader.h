@@ -8,7 +8,9 @@
  *
  * @param payloadStart Address to begin the load.
  * @param moduleTargetAddress Addresses of the modules to load.
+ *
+ * @returns - The address right past the end of the module loaded highest in memory.
  */
-void loadModules(void *payloadStart, void **moduleTargetAddress);
+void *loadModules(void *payloadStart, void **moduleTargetAddress);
 
 #endif
\ No newline at end of file
@@ -3,6 +3,21 @@
 
 #include <defs.h>
 
+/**
+ * @brief Gets the process table slot of a PID.
+ */
+#define PID_TO_SLOT(pid) ((pid) & (MAX_PROCESSES - 1))
+
+/**
+ * @brief Builds a PID from a process table slot and its generation.
+ */
+#define MAKE_PID(slot, generation) ((Pid) (((generation) << PID_SLOT_BITS) | (slot)))
+
+/**
+ * @brief Generations wrap around before reaching the sign bit, so that PIDs are never negative.
+ */
+#define MAX_PID_GENERATION ((1u << (31 - PID_SLOT_BITS)) - 1)
+
 /**
  * @brief Creates a new process from a ProcessCreateInfo struct.
  *
@@ -152,13 +167,16 @@ ssize_t handleWrite(Pid pid, int fd, const char *buffer, size_t count);
 int unblockOnKilled(Pid pidToUnblock, Pid pidToWait);
 
 /**
- * @brief Gets (maxProcesses)-amount information of processes.
+ * @brief Gets (maxProcesses)-amount information of processes, starting at a position of the process table.
+ * Calling it repeatedly with the same cursor pages through the whole table.
  *
  * @param storingInfo Array of ProcessInfo to archive the data.
  * @param maxProcesses Limit.
+ * @param cursor Position in the process table to start from, 0 for the beginning. It is updated to the position
+ * where the next page starts.
  *
- * @returns - The amount of processes archived.
+ * @returns - The amount of processes archived, 0 once the end of the table is reached.
  */
-uint8_t listProcesses(ProcessInfo *storingInfo, uint8_t maxProcesses);
+int listProcesses(ProcessInfo *storingInfo, int maxProcesses, unsigned int *cursor);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,114 @@
+#ifndef _READY_QUEUE_H_
+#define _READY_QUEUE_H_
+
+#include <defs.h>
+
+/**
+ * @brief Returned by takeNextReadyProcess() when no process is ready to run.
+ */
+#define NO_READY_PROCESS -1
+
+/*
+ * The ready queue holds every READY process and decides which one runs next and for how long. The scheduler
+ * policy is picked at build time: priority-based round robin by default, a proportional-share (CFS-like) policy
+ * when compiled with SCHED=USE_CFS, or a multi-level feedback queue when compiled with SCHED=USE_MLFQ.
+ */
+
+/**
+ * @brief Initializes the ready queue.
+ */
+void initializeReadyQueue();
+
+/**
+ * @brief Makes room in the ready queue for processes living in process table slots below size.
+ *
+ * @param size Amount of process table slots.
+ *
+ * @returns - 0 if the operation is successful, 1 otherwise.
+ */
+int resizeReadyQueue(unsigned int size);
+
+/**
+ * @brief Resets the ready queue bookkeeping of a newly created process.
+ *
+ * @param pid PID of the process.
+ * @param priority Priority of the process.
+ */
+void resetReadyProcess(Pid pid, Priority priority);
+
+/**
+ * @brief Changes the priority the ready queue uses for a process. The process must not be in the queue.
+ *
+ * @param pid PID of the process.
+ * @param priority New priority.
+ */
+void setReadyPriority(Pid pid, Priority priority);
+
+/**
+ * @brief Adds a process that became READY to the queue.
+ *
+ * @param pid PID of the process.
+ */
+void addReadyProcess(Pid pid);
+
+/**
+ * @brief Removes a READY process from the queue.
+ *
+ * @param pid PID of the process.
+ */
+void removeReadyProcess(Pid pid);
+
+/**
+ * @brief Checks whether any process is waiting in the queue.
+ *
+ * @returns - 1 if the queue has at least one process, 0 otherwise.
+ */
+int hasReadyProcess();
+
+/**
+ * @brief Removes the process that should run next from the queue.
+ *
+ * @returns - The PID of the process, or NO_READY_PROCESS if the queue is empty.
+ */
+Pid takeNextReadyProcess();
+
+/**
+ * @brief Called before a running process hands the CPU to another one. The next startSlice() of the receiver continues
+ * the slice of the giver instead of starting a new one.
+ *
+ * @param from PID of the running process.
+ * @param to PID of the process receiving the rest of the slice.
+ */
+void donateSlice(Pid from, Pid to);
+
+/**
+ * @brief Called when a process is given the CPU.
+ *
+ * @param pid PID of the process.
+ */
+void startSlice(Pid pid);
+
+/**
+ * @brief Called on every scheduler tick while a process keeps the CPU.
+ *
+ * @param pid PID of the running process.
+ *
+ * @returns - 1 if the process should be preempted, 0 otherwise.
+ */
+int shouldPreempt(Pid pid);
+
+/**
+ * @brief Called when the running process blocks, before its slice ends.
+ *
+ * @param pid PID of the process.
+ */
+void blockSlice(Pid pid);
+
+/**
+ * @brief Called when a process stops running, whatever the reason.
+ *
+ * @param pid PID of the process.
+ */
+void endSlice(Pid pid);
+
+#endif
@@ -0,0 +1,113 @@
+#ifndef _REAL_TIME_H_
+#define _REAL_TIME_H_
+
+#include <defs.h>
+
+/*
+ * Earliest-deadline-first class for periodic processes. Every period a real-time process is released a new job with
+ * runtime ticks of budget that must complete within deadline ticks of the release. Eligible real-time processes
+ * always run ahead of the ready queue, earliest absolute deadline first, and are throttled until their next release
+ * once their budget is spent. All times are in ticks.
+ */
+
+/**
+ * @brief Initializes the real-time class.
+ */
+void initializeRealTime();
+
+/**
+ * @brief Makes room in the real-time class for processes living in process table slots below size.
+ *
+ * @param size Amount of process table slots.
+ *
+ * @returns - 0 if the operation is successful, 1 otherwise.
+ */
+int resizeRealTime(unsigned int size);
+
+/**
+ * @brief Moves a process into the real-time class, or updates its parameters, releasing its first job now. The
+ * request is rejected if the total density of the real-time class, the sum of runtime over deadline, would exceed
+ * what the CPU can guarantee. A period of 0 moves the process back to the ready queue. The process must not be queued.
+ *
+ * @param pid PID of the process.
+ * @param period Ticks between job releases.
+ * @param runtime Budget of each job, at most deadline.
+ * @param deadline Ticks after a release by which the job must be done, at most period.
+ * @param now Current amount of ticks elapsed since startup.
+ *
+ * @returns - 0 if the operation is successful, 1 otherwise.
+ */
+int setRealTimeParameters(Pid pid, unsigned long period, unsigned long runtime, unsigned long deadline, unsigned long now);
+
+/**
+ * @brief Checks whether a process belongs to the real-time class.
+ *
+ * @param pid PID of the process.
+ *
+ * @returns - 1 if it does, 0 otherwise.
+ */
+int isRealTimeProcess(Pid pid);
+
+/**
+ * @brief Adds a real-time process that became READY to the class run queue.
+ *
+ * @param pid PID of the process.
+ */
+void addRealTimeProcess(Pid pid);
+
+/**
+ * @brief Removes a READY real-time process from the class run queue.
+ *
+ * @param pid PID of the process.
+ */
+void removeRealTimeProcess(Pid pid);
+
+/**
+ * @brief Gets the queued real-time process with budget left and the earliest absolute deadline, releasing new jobs
+ * first if they are due. The process stays queued.
+ *
+ * @param now Current amount of ticks elapsed since startup.
+ *
+ * @returns - The PID of the process, or NO_READY_PROCESS if none is eligible.
+ */
+Pid peekRealTimeProcess(unsigned long now);
+
+/**
+ * @brief Charges the time a running real-time process consumed since it was started or last charged, releasing a
+ * new job first if it is due.
+ *
+ * @param pid PID of the process.
+ * @param now Current amount of ticks elapsed since startup.
+ *
+ * @returns - 1 if the process still has budget left, 0 if it must be throttled until its next release.
+ */
+int chargeRealTimeProcess(Pid pid, unsigned long now);
+
+/**
+ * @brief Invoked when a real-time process starts running, to begin charging its budget.
+ *
+ * @param pid PID of the process.
+ * @param now Current amount of ticks elapsed since startup.
+ */
+void startRealTimeProcess(Pid pid, unsigned long now);
+
+/**
+ * @brief Checks whether a real-time process has to wait for a real-time process with an earlier deadline.
+ *
+ * @param pid PID of the process.
+ * @param other PID of the other real-time process.
+ *
+ * @returns - 1 if the absolute deadline of other is earlier, 0 otherwise.
+ */
+int hasEarlierDeadline(Pid pid, Pid other);
+
+/**
+ * @brief Gets how many ticks can elapse before a throttled, queued real-time process is released again.
+ *
+ * @param now Current amount of ticks elapsed since startup.
+ *
+ * @returns - The amount of ticks, or 0 if no real-time process is waiting for a release.
+ */
+unsigned long getTicksToNextRelease(unsigned long now);
+
+#endif
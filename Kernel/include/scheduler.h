@@ -18,7 +18,7 @@ void initializeScheduler();
  * @param argc Amount of arguments.
  * @param argv Arguments.
  *
- * @returns - 0 if the operation is successful.
+ * @returns - 0 if the operation is successful, 1 otherwise.
  */
 int onProcessCreated(Pid pid, ProcessStart start, Priority priority, void *currentRSP, int argc, const char *const argv[]);
 
@@ -68,6 +68,51 @@ Pid getpid();
  */
 int setPriority(Pid pid, Priority newPriority);
 
+/**
+ * @brief Raises the effective priority of a process to the given one, if it is higher. The process keeps it until
+ * restorePriority() is called.
+ *
+ * @param pid PID of the process.
+ * @param priority Priority to inherit.
+ *
+ * @returns - 0 if the operation is successful, 1 otherwise.
+ */
+int inheritPriority(Pid pid, Priority priority);
+
+/**
+ * @brief Drops any inherited priority, going back to the priority set at creation or by setPriority().
+ *
+ * @param pid PID of the process.
+ *
+ * @returns - 0 if the operation is successful, 1 otherwise.
+ */
+int restorePriority(Pid pid);
+
+/**
+ * @brief Gets the effective priority of a process.
+ *
+ * @param pid PID of the process.
+ *
+ * @returns - The priority, or PRIORITY_DEFAULT if the process does not exist.
+ */
+Priority getPriority(Pid pid);
+
+/**
+ * @brief Switches to an important process woken up since the last context switch, if it should preempt the current
+ * one. Invoked on the way out of system calls.
+ */
+void reschedule();
+
+/**
+ * @brief Invoked on the way out of device interrupts. Switches to an important process woken up by the interrupt, if
+ * it should preempt the current one.
+ *
+ * @param currentRSP RSP (Stack Pointer) of the interrupted process.
+ *
+ * @returns - RSP (Stack Pointer) of the process to be resumed.
+ */
+void *rescheduleFromInterrupt(void *currentRSP);
+
 /**
  * @brief Determines the next process to be executed with priority-based Round Robin algorithm.
  *
@@ -87,12 +132,51 @@ void *switchProcess(void *currentRSP);
  */
 int getProcessInfo(Pid pid, ProcessInfo *processInfo);
 
+/**
+ * @brief Moves a process into the earliest-deadline-first real-time class, which runs ahead of every other process.
+ * Each period the process gets runtime milliseconds of CPU that must be used within deadline milliseconds, and it is
+ * throttled until the next period once they are spent. The request is rejected unless the real-time class is still
+ * guaranteed to meet every deadline.
+ *
+ * @param pid PID of the process.
+ * @param period Period in milliseconds, or 0 to move the process back to priority scheduling.
+ * @param runtime Budget per period in milliseconds, at most deadline.
+ * @param deadline Relative deadline in milliseconds, at most period.
+ *
+ * @returns - 0 if the operation is successful, 1 otherwise.
+ */
+int setRealTime(Pid pid, unsigned long period, unsigned long runtime, unsigned long deadline);
+
+/**
+ * @brief Checks whether any process is waiting for the CPU.
+ *
+ * @returns - 1 if at least one process is READY and may run, 0 otherwise.
+ */
+int hasReadyProcesses();
+
+/**
+ * @brief Gets how many ticks the CPU may stay idle before the scheduler has work to do, be it a sleeper to wake up or
+ * a throttled real-time process to release.
+ *
+ * @returns - The amount of ticks, or 0 if there is no deadline.
+ */
+unsigned long getIdleTicks();
+
 /**
  * @brief Relinquishes CPU control to the next process on the ready list.
  * If the caller is not a process or has exited, this function does not return.
  */
 void yield();
 
+/**
+ * @brief Hands the CPU straight to a process that was just woken up, donating the rest of the caller's time slice,
+ * so producer-consumer pairs do not wait for the caller's quantum to end. Does nothing unless the target is READY and
+ * at least as important as the caller, or if real-time processes are involved.
+ *
+ * @param pid PID of the process to run.
+ */
+void yieldTo(Pid pid);
+
 /**
  * @brief Kills the process that is currently RUNNING.
  */
@@ -12,7 +12,8 @@
 int initializeSem();
 
 /**
- * @brief Creates a named semaphore, or opens if exists.
+ * @brief Creates a named semaphore, or opens if exists. A semaphore created with an initial value of 1 is used as
+ * a mutex: while a higher-priority process waits on it, the process holding it inherits that priority until it posts.
  *
  * @param name Semaphore's name.
  * @param initialValue Semaphore's initial value.
@@ -0,0 +1,21 @@
+#ifndef _SERIAL_H_
+#define _SERIAL_H_
+
+#include <defs.h>
+
+/**
+ * @brief Initializes the first serial port (COM1) at 115200 baud, 8N1.
+ */
+void initializeSerial();
+
+/**
+ * @brief Writes as many characters to the serial port as it can take without waiting.
+ *
+ * @param buffer The characters to be written.
+ * @param length Amount of characters in buffer.
+ *
+ * @returns - The amount of characters written, 0 if the transmitter is busy.
+ */
+int trySerialWrite(const char *buffer, int length);
+
+#endif
@@ -0,0 +1,69 @@
+#ifndef _SLAB_H_
+#define _SLAB_H_
+
+#include <defs.h>
+#include <frameAllocator.h>
+#include <stddef.h>
+
+/*
+ * Object caches for fixed-size kernel objects. Each cache carves slabs, page frames set aside for them at boot, into
+ * objects of a single type, so allocating and freeing an object is O(1) and does not fragment the general heap.
+ * Slabs are aligned to their size, so the slab of an object is found from its address alone. Objects are run through
+ * the constructor of the cache once, when their slab is created, and must be handed back in that constructed state.
+ */
+
+/**
+ * @brief Size in bytes of the slabs every cache takes, one page frame each.
+ */
+#define SLAB_SIZE FRAME_SIZE
+
+/**
+ * @brief Brings a newly carved object to the state the cache hands it out in.
+ */
+typedef void (*ObjectConstructor)(void *object);
+
+/**
+ * @brief Cache of objects of a single type. Its fields are private to the slab allocator.
+ */
+typedef struct {
+    size_t objectSize;
+    ObjectConstructor constructor;
+    struct Slab *partialSlabs;  // Slabs with free objects left
+    struct Slab *emptySlab;     // Kept so a cache going back and forth around a slab boundary does not thrash the heap
+} ObjectCache;
+
+/**
+ * @brief Static initializer of an object cache.
+ *
+ * @param type Type of the objects.
+ * @param constructor Function run on every new object, or NULL.
+ */
+#define OBJECT_CACHE(type, constructor) {sizeof(type), (constructor), NULL, NULL}
+
+/**
+ * @brief Takes the page frames slabs are carved from. Must be called after the frame allocator is initialized and
+ * before the memory manager is given the remaining page frames.
+ */
+void initializeSlabs();
+
+/**
+ * @brief Takes a free object from a cache.
+ *
+ * @param cache The object cache.
+ *
+ * @returns - A pointer to the object, or NULL if the operation failed.
+ */
+void *allocateObject(ObjectCache *cache);
+
+/**
+ * @brief Gives back an object taken from a cache. Slabs left without objects in use are returned to the pool of page
+ * frames, except for one per cache.
+ *
+ * @param cache The object cache the object was taken from.
+ * @param object Pointer to the object, or NULL.
+ *
+ * @returns - 0 if the operation is successful, 1 if the object is not in use in the cache.
+ */
+int freeObject(ObjectCache *cache, void *object);
+
+#endif
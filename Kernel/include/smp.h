@@ -0,0 +1,37 @@
+#ifndef _SMP_H_
+#define _SMP_H_
+
+#include <defs.h>
+
+/*
+ * Groundwork for SMP. Pure64 starts every application processor (AP) and parks it halted. initializeSmp() brings the
+ * APs into the kernel, each one on its own stack and with its per-CPU data reachable through the GS base. There are no
+ * per-CPU ready queues, reschedule IPIs or locking of the shared kernel state yet, so the APs stay halted in the
+ * kernel and every process runs on the bootstrap processor (BSP).
+ */
+
+/**
+ * @brief Amount of CPUs the kernel keeps per-CPU data for.
+ */
+#define MAX_CPUS 16
+
+/**
+ * @brief Sets up the per-CPU data of the BSP and brings the APs into the kernel. Must be called on the BSP, with
+ * interrupts disabled, after the memory manager and the Local APIC are initialized.
+ */
+void initializeSmp();
+
+/**
+ * @brief Invoked by apStartHandler on an AP. Acknowledges the start IPI and finds the stack of the AP.
+ *
+ * @returns - The top of the stack of the AP, or NULL if it is not known to the kernel.
+ */
+void *getApStack();
+
+/**
+ * @brief Entry point of an AP, running on its own stack with interrupts disabled. apStartHandler parks the AP once it
+ * returns.
+ */
+void apMain();
+
+#endif
@@ -3,21 +3,55 @@
 
 #include <defs.h>
 
+/**
+ * @brief Amount of timer interrupts per second. Can be overridden at build time with HZ=<frequency>.
+ */
+#ifndef TICK_FREQUENCY
+#define TICK_FREQUENCY 1000
+#endif
+
 /**
  * @brief Converts ticks to seconds.
  */
-#define TICKS_TO_SECONDS(x) ((x) *5 / 91)
+#define TICKS_TO_SECONDS(x) ((x) / TICK_FREQUENCY)
 
 /**
  * @brief Converts ticks to miliseconds.
  */
-#define TICKS_TO_MILLISECONDS(x) ((x) *5000 / 91);
+#define TICKS_TO_MILLISECONDS(x) ((x) *1000 / TICK_FREQUENCY)
 
 /**
- * @brief Invoked by the interrupt dispatcher when a timer interrupt is detected. Increments ticks.
+ * @brief Converts miliseconds to ticks, rounding up.
+ */
+#define MILLISECONDS_TO_TICKS(x) (((x) *TICK_FREQUENCY + 999) / 1000)
+
+/**
+ * @brief Programs the system tick at TICK_FREQUENCY. The Local APIC timer is used when the bootloader found one,
+ * otherwise the PIT. Must be called with interrupts disabled, after initializeLocalApic().
+ */
+void initializeTimer();
+
+/**
+ * @brief Invoked by the interrupt dispatcher when a timer interrupt is detected. Increments ticks and wakes up
+ * the processes whose sleep expired.
  */
 void interruptHandlerRTC();
 
+/**
+ * @brief Stops the periodic tick and halts the CPU until the next interrupt. The timer fires once after the given
+ * amount of ticks, or as late as the hardware allows if zero, and the time spent halted is added to the elapsed
+ * ticks on wake up. Must be called with interrupts disabled, and returns with them disabled.
+ *
+ * @param wakeupTicks Maximum amount of ticks to stay halted, or 0 if there is no deadline.
+ */
+void idleTickless(unsigned long wakeupTicks);
+
+/**
+ * @brief Restarts the periodic tick if it was stopped by idleTickless(), adding the time spent halted to the elapsed
+ * ticks. Does nothing otherwise. Must be called with interrupts disabled.
+ */
+void resumeTick();
+
 /**
  * @brief Gets the total amount of ticks elapsed since startup.
  *
@@ -0,0 +1,53 @@
+#ifndef _TIMER_WHEEL_H_
+#define _TIMER_WHEEL_H_
+
+#include <defs.h>
+
+/**
+ * @brief Initializes the timer wheel.
+ */
+void initializeTimerWheel();
+
+/**
+ * @brief Makes room in the timer wheel for processes living in process table slots below size.
+ *
+ * @param size Amount of process table slots.
+ *
+ * @returns - 0 if the operation is successful, 1 otherwise.
+ */
+int resizeTimerWheel(unsigned int size);
+
+/**
+ * @brief Arms a timer that unblocks a process once the given amount of ticks has elapsed. If the process already
+ * had a timer armed, it is replaced. The caller is responsible for blocking the process.
+ *
+ * @param pid PID of the process.
+ * @param ticks Amount of ticks to wait, at least one.
+ *
+ * @returns - 0 if the operation is successful, 1 otherwise.
+ */
+int addSleeper(Pid pid, unsigned long ticks);
+
+/**
+ * @brief Disarms the timer of a process, if it has one.
+ *
+ * @param pid PID of the process.
+ */
+void cancelSleeper(Pid pid);
+
+/**
+ * @brief Gets how many ticks can elapse before the timer wheel needs to run again. The result may be earlier than the
+ * nearest timer, but never later.
+ *
+ * @returns - The amount of ticks, or 0 if no timer is armed.
+ */
+unsigned long getTicksToNextTimer();
+
+/**
+ * @brief Invoked on every timer interrupt. Unblocks every process whose timer expired up to the given tick.
+ *
+ * @param now Current amount of ticks elapsed since startup.
+ */
+void advanceTimerWheel(unsigned long now);
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef _TRACE_H_
+#define _TRACE_H_
+
+#include <defs.h>
+
+/*
+ * The scheduler trace keeps the last TRACE_BUFFER_SIZE scheduler events in a ring buffer. Events are only recorded
+ * from kernel code running with interrupts disabled, so the buffer needs no locking.
+ */
+
+/**
+ * @brief Records a scheduler event, timestamped with the time-stamp counter.
+ *
+ * @param type Kind of event.
+ * @param pid PID of the process the event is about.
+ * @param other Additional information, as described by TraceEvent.
+ */
+void traceEvent(TraceEventType type, Pid pid, Pid other);
+
+/**
+ * @brief Copies recorded events, oldest first, starting at the given position of the trace. Events already
+ * overwritten are skipped.
+ *
+ * @param array Array to store the events.
+ * @param maxEvents Maximum amount of events to copy.
+ * @param cursor Position of the trace to start at, 0 for the oldest event still available. Updated to the position
+ * following the last copied event.
+ *
+ * @returns - The amount of events copied.
+ */
+int readTrace(TraceEvent *array, int maxEvents, unsigned long *cursor);
+
+/**
+ * @brief Enables or disables streaming the trace through the serial port. Only events recorded from then on are
+ * streamed, one text line per event.
+ *
+ * @param enabled 1 to enable, 0 to disable.
+ */
+void setTraceStreaming(int enabled);
+
+/**
+ * @brief Invoked on every timer interrupt. Sends pending events through the serial port, as long as it does not
+ * have to wait for it.
+ */
+void streamTrace();
+
+#endif
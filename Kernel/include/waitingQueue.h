@@ -41,6 +41,15 @@ int addInQueue(WaitingQueue queue, Pid pid);
  */
 int entriesInQueue(WaitingQueue queue);
 
+/**
+ * @brief Gets the PID at the head of the queue, the next one unblockInQueue() would wake up.
+ *
+ * @param queue The waiting queue.
+ *
+ * @returns - The PID, or -1 if the queue is empty.
+ */
+Pid peekInQueue(WaitingQueue queue);
+
 /**
  * @brief Gets if the pid is in the queue or not.
  *
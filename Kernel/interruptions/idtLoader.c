@@ -26,6 +26,7 @@ loadIDT() {
     // Exceptions
     setupIDTEntry(0x00, (uint64_t) &exception0Handler);
     setupIDTEntry(0x06, (uint64_t) &exception6Handler);
+    setupIDTEntry(0x07, (uint64_t) &exception7Handler);
     setupIDTEntry(0x0D, (uint64_t) &exception0DHandler);
     setupIDTEntry(0x0E, (uint64_t) &exception0EHandler);
 
@@ -36,6 +37,7 @@ loadIDT() {
     // Software Interrupts
     setupIDTEntry(0x80, (uint64_t) &syscallHandler);
     setupIDTEntry(0x81, (uint64_t) &awakeScheduler);
+    setupIDTEntry(0x82, (uint64_t) &apStartHandler);
 
     // 1111 1100 timer-tick and keyboard
     picMasterMask(0xFC);
@@ -1,4 +1,6 @@
+#include <apic.h>
 #include <defs.h>
+#include <frameAllocator.h>
 #include <graphics.h>
 #include <idtLoader.h>
 #include <interrupts.h>
@@ -10,6 +12,10 @@
 #include <process.h>
 #include <scheduler.h>
 #include <sem.h>
+#include <smp.h>
+#include <serial.h>
+#include <slab.h>
+#include <time.h>
 
 extern uint8_t text;
 extern uint8_t rodata;
@@ -21,8 +27,7 @@ extern uint8_t endOfKernel;
 static const uint64_t PageSize = 0x1000;
 static void *const sampleCodeModuleAddress = (void *) 0x400000;
 static void *const sampleDataModuleAddress = (void *) 0x500000;
-static void *const startHeapAddres = (void *) 0xF00000;
-static void *const endHeapAddres = (void *) 0x2000000;
+static void *modulesEnd;
 
 void
 clearBSS(void *bssAddress, uint64_t bssSize) {
@@ -38,13 +43,34 @@ void *
 initializeKernelBinary() {
     void *moduleAddresses[] = {sampleCodeModuleAddress, sampleDataModuleAddress};
 
-    loadModules(&endOfKernelBinary, moduleAddresses);
+    void *loadedModulesEnd = loadModules(&endOfKernelBinary, moduleAddresses);
 
     clearBSS(&bss, &endOfKernel - &bss);
+    modulesEnd = loadedModulesEnd;
 
     return getStackBase();
 }
 
+static void
+initializeHeap() {
+    initializeFrameAllocator();
+
+    // The kernel image along with its stack, the modules and the framebuffer are already in use.
+    reserveFrames(&text, &endOfKernel + PageSize * 8 - &text);
+    reserveFrames(sampleCodeModuleAddress, modulesEnd - sampleCodeModuleAddress);
+    size_t framebufferSize;
+    void *framebuffer = getFramebuffer(&framebufferSize);
+    reserveFrames(framebuffer, framebufferSize);
+    initializeSlabs();
+
+    // The largest range goes first, the rest of the physical memory is then added piece by piece.
+    void *rangeStart;
+    size_t rangeSize = takeFrameRange(&rangeStart);
+    initializeMemory(rangeStart, rangeSize);
+    while ((rangeSize = takeFrameRange(&rangeStart)) != 0)
+        addMemory(rangeStart, rangeSize);
+}
+
 void
 initializeShell() {
     ProcessCreateInfo shellInfo = {"shell", (ProcessStart) sampleCodeModuleAddress, 1, PRIORITY_MAX, 0, NULL};
@@ -63,10 +89,14 @@ main() {
 
     loadIDT();
     initializeScreen();
-    initializeMemory(startHeapAddres, (size_t) (endHeapAddres - startHeapAddres));
+    initializeHeap();
     initializeKeyboard();
     initializeScheduler();
     initializeSem();
+    initializeLocalApic();
+    initializeTimer();
+    initializeSmp();
+    initializeSerial();
 
     initializeShell();
 
@@ -75,7 +105,12 @@ main() {
 
     while (1) {
         yield();
-        hlt();
+
+        // Nothing is ready to run: stop ticking until the nearest sleeper or release is due or a device interrupts.
+        cli();
+        if (!hasReadyProcesses())
+            idleTickless(getIdleTicks());
+        sti();
     }
 
     return 0;
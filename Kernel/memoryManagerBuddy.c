@@ -4,23 +4,42 @@
 #include <lib.h>
 #include <memoryManager.h>
 
-#define MAX_LEVEL        23
-#define MIN_LEVEL        8
-#define MIN_MEMORY_SIZE  (9 * 1024 * 1024)
-#define HEAP_MEMORY_SIZE (8 * 1024 * 1024)
-#define MAX_NODES        65535
-#define TRUE             1
-#define FALSE            0
-#define POSITIVE_DELTA   1
-#define NEGATIVE_DELTA   -1
-
+// Pure64 identity maps the first 64 GiB, so no zone can be larger than that.
+#define MAX_LEVEL 36
+#define MIN_LEVEL 8
+#define MAX_ZONES 16
+
+#define BLOCK_SIZE(level)       ((size_t) 1 << (level))
+#define NODES_OF_ZONE(maxLevel) (BLOCK_SIZE((maxLevel) - MIN_LEVEL + 1) - 1)
+
+/*
+ * State of every node of the tree. Only nodes reachable from the root through split nodes are meaningful, the rest
+ * lie inside a free or allocated block and are left unused, so allocating or freeing a block never touches them.
+ */
+#define NODE_UNUSED    0
+#define NODE_FREE      1  // Whole free block, linked in the free list of its level
+#define NODE_SPLIT     2
+#define NODE_ALLOCATED 3
+
+// Free blocks keep the links of their free list in their own first bytes.
+typedef struct FreeBlock {
+    struct FreeBlock *previous;
+    struct FreeBlock *next;
+} FreeBlock;
+
+/*
+ * Independent buddy tree over a power of two sized part of the heap. Every segment given to the memory manager is
+ * carved into as many zones as needed to cover it, each one preceded by its node array.
+ */
 typedef struct {
-    unsigned int occupied;
-    unsigned int occupiedSubnodes;
-} Node;
-
-static void *heapStart;
-static Node *nodes;
+    void *heapStart;
+    unsigned int maxLevel;
+    uint8_t *nodes;
+    FreeBlock *freeLists[MAX_LEVEL + 1];
+} Zone;
+
+static Zone zones[MAX_ZONES];
+static unsigned int zoneCount;
 static size_t totalMemory;
 static size_t usedMemory;
 static unsigned int memoryChunks;
@@ -41,61 +60,139 @@ getParentIndex(unsigned int index) {
 }
 
 static inline unsigned int
-getFirstIndexOfLevel(unsigned int level) {
-    return (1 << (MAX_LEVEL - level)) - 1;
+getBuddyIndex(unsigned int index) {
+    return (index & 1) ? index + 1 : index - 1;
+}
+
+static inline unsigned int
+getFirstIndexOfLevel(const Zone *zone, unsigned int level) {
+    return (1U << (zone->maxLevel - level)) - 1;
+}
+
+static inline void *
+getAddress(const Zone *zone, int index, int level) {
+    return zone->heapStart + (index - getFirstIndexOfLevel(zone, level)) * BLOCK_SIZE(level);
+}
+
+static inline int
+getIndex(const Zone *zone, void *address, int level) {
+    return getFirstIndexOfLevel(zone, level) + ((address - zone->heapStart) >> level);
 }
 
+static void
+pushFreeBlock(Zone *zone, int index, int level) {
+    FreeBlock *block = getAddress(zone, index, level);
+    block->previous = NULL;
+    block->next = zone->freeLists[level];
+    if (block->next != NULL)
+        block->next->previous = block;
+    zone->freeLists[level] = block;
+    zone->nodes[index] = NODE_FREE;
+}
+
+static void
+removeFreeBlock(Zone *zone, int index, int level) {
+    FreeBlock *block = getAddress(zone, index, level);
+    if (block->previous == NULL)
+        zone->freeLists[level] = block->next;
+    else
+        block->previous->next = block->next;
+
+    if (block->next != NULL)
+        block->next->previous = block->previous;
+    zone->nodes[index] = NODE_UNUSED;
+}
+
+// Splits a block down to the given level, keeping the left half of every split and freeing the right half.
 static int
-getFirstFreeIndexOfLevel(unsigned int level) {
-    int idx = getFirstIndexOfLevel(level);
-    int lastIdx = getFirstIndexOfLevel(level - 1);
+splitBlock(Zone *zone, int index, unsigned int level, unsigned int targetLevel) {
+    while (level > targetLevel) {
+        zone->nodes[index] = NODE_SPLIT;
+        level--;
+        pushFreeBlock(zone, getRightChildIndex(index), level);
+        index = getLeftChildIndex(index);
+    }
 
-    while (idx < lastIdx && (nodes[idx].occupied || nodes[idx].occupiedSubnodes))
-        ++idx;
+    zone->nodes[index] = NODE_ALLOCATED;
+    return index;
+}
 
-    if (idx == lastIdx)
+// Takes a free block of the given level, splitting the smallest larger block available if there is none.
+static int
+takeFreeBlock(Zone *zone, unsigned int level) {
+    unsigned int freeLevel = level;
+    while (freeLevel <= zone->maxLevel && zone->freeLists[freeLevel] == NULL)
+        freeLevel++;
+
+    if (freeLevel > zone->maxLevel)
         return -1;
 
-    return idx;
+    int index = getIndex(zone, zone->freeLists[freeLevel], freeLevel);
+    removeFreeBlock(zone, index, freeLevel);
+    return splitBlock(zone, index, freeLevel, level);
 }
 
-static void
-setAsOccupied(int idx, int occupied) {
-    if (idx < 0 || idx >= MAX_NODES)
-        return;
+// Grows an allocated block up to the given level without moving it, if it is the left half at every level on the way
+// and all the right halves are free.
+static int
+growBlock(Zone *zone, int index, unsigned int level, unsigned int targetLevel) {
+    if (targetLevel > zone->maxLevel)
+        return 0;
+
+    int candidate = index;
+    for (unsigned int l = level; l < targetLevel; l++) {
+        if ((candidate & 1) == 0 || zone->nodes[getBuddyIndex(candidate)] != NODE_FREE)
+            return 0;
+        candidate = getParentIndex(candidate);
+    }
+
+    zone->nodes[index] = NODE_UNUSED;
+    for (; level < targetLevel; level++) {
+        removeFreeBlock(zone, getBuddyIndex(index), level);
+        index = getParentIndex(index);
+    }
 
-    nodes[idx].occupied = occupied;
-    setAsOccupied(getRightChildIndex(idx), occupied);
-    setAsOccupied(getLeftChildIndex(idx), occupied);
+    zone->nodes[index] = NODE_ALLOCATED;
+    return 1;
 }
 
+// Gives back a block, merging it with its buddy for as long as the buddy is free as a whole.
 static void
-updateParents(unsigned int idx, int occupiedDelta) {
-    nodes[idx].occupiedSubnodes += occupiedDelta;
-    while (idx != 0) {
-        idx = getParentIndex(idx);
-        nodes[idx].occupiedSubnodes += occupiedDelta;
+releaseBlock(Zone *zone, int index, unsigned int level) {
+    zone->nodes[index] = NODE_UNUSED;
+
+    while (level < zone->maxLevel && zone->nodes[getBuddyIndex(index)] == NODE_FREE) {
+        removeFreeBlock(zone, getBuddyIndex(index), level);
+        index = getParentIndex(index);
+        level++;
     }
-}
 
-static inline void *
-getAddress(int index, int level) {
-    return heapStart + (index - getFirstIndexOfLevel(level)) * (1 << level);
+    pushFreeBlock(zone, index, level);
 }
 
+// Follows split nodes down from the root to the block that holds ptr.
 static int
-searchNode(int idx, int *level, void *ptr) {
-    if (*level < MIN_LEVEL)
-        return -1;
+findAllocatedBlock(const Zone *zone, void *ptr, unsigned int *level) {
+    int index = 0;
+    *level = zone->maxLevel;
 
-    if (!nodes[idx].occupied) {
+    while (zone->nodes[index] == NODE_SPLIT) {
         (*level)--;
-        int rightChildIndex = getRightChildIndex(idx);
-        void *address = getAddress(rightChildIndex, *level);
-        return searchNode(ptr < address ? getLeftChildIndex(idx) : rightChildIndex, level, ptr);
+        int rightChildIndex = getRightChildIndex(index);
+        index = ptr < getAddress(zone, rightChildIndex, *level) ? getLeftChildIndex(index) : rightChildIndex;
+    }
+
+    return zone->nodes[index] == NODE_ALLOCATED && ptr == getAddress(zone, index, *level) ? index : -1;
+}
+
+static Zone *
+findZone(void *ptr) {
+    for (unsigned int i = 0; i < zoneCount; i++) {
+        if (ptr >= zones[i].heapStart && ptr < zones[i].heapStart + BLOCK_SIZE(zones[i].maxLevel))
+            return &zones[i];
     }
 
-    return ptr == getAddress(idx, *level) ? idx : -1;
+    return NULL;
 }
 
 static unsigned int
@@ -109,68 +206,78 @@ getLevel(size_t size) {
     return level;
 }
 
-static int
-getMaxPosibleLevel(void *ptr) {
-    int relativeAddress = ptr - heapStart;
-    int level = MAX_LEVEL;
-    int powOfTwo = 1 << MAX_LEVEL;
-    while ((relativeAddress % powOfTwo) != 0) {
+// Gets the level of the largest zone that fits between start and end along with its node array.
+static unsigned int
+getZoneLevel(void *start, void *end) {
+    size_t available = end > start ? end - start : 0;
+
+    unsigned int level = MAX_LEVEL;
+    while (level >= MIN_LEVEL && WORD_ALIGN_UP(NODES_OF_ZONE(level)) + BLOCK_SIZE(level) > available)
         level--;
-        powOfTwo = powOfTwo >> 1;
-    }
+
     return level;
 }
 
-static int
-getStartSearchingIdx(void *ptr, int maxLevel) {
-    int relativeAddress = ptr - heapStart;
-    return getFirstIndexOfLevel(maxLevel) + (relativeAddress / (1 << maxLevel));
+static void
+initializeZone(Zone *zone, void *start, unsigned int maxLevel) {
+    zone->maxLevel = maxLevel;
+    zone->nodes = start;
+    zone->heapStart = start + WORD_ALIGN_UP(NODES_OF_ZONE(maxLevel));
+
+    memset(zone->nodes, NODE_UNUSED, NODES_OF_ZONE(maxLevel));
+    for (int level = 0; level <= MAX_LEVEL; level++)
+        zone->freeLists[level] = NULL;
+    pushFreeBlock(zone, 0, maxLevel);
+
+    totalMemory += BLOCK_SIZE(maxLevel);
 }
 
 void
 initializeMemory(void *memoryStart, size_t memorySize) {
-    void *actualStart = (void *) WORD_ALIGN_UP(memoryStart);
-    memorySize -= (actualStart - memoryStart);
-
-    if (memorySize < MIN_MEMORY_SIZE)
-        return;
-
-    nodes = actualStart;
-    size_t nodesMemorySize = sizeof(Node) * MAX_NODES;
-    actualStart += nodesMemorySize;
-    heapStart = actualStart;
-
-    totalMemory = HEAP_MEMORY_SIZE;
+    zoneCount = 0;
+    totalMemory = 0;
     usedMemory = 0;
     memoryChunks = 0;
 
-    for (int i = 0; i < MAX_NODES; ++i) {
-        nodes[i].occupied = 0;
-        nodes[i].occupiedSubnodes = 0;
+    addMemory(memoryStart, memorySize);
+}
+
+void
+addMemory(void *memoryStart, size_t memorySize) {
+    void *zoneStart = (void *) WORD_ALIGN_UP(memoryStart);
+    void *memoryEnd = memoryStart + memorySize;
+
+    // Carve the region into the largest zones that fit, so most of it is covered by a handful of trees.
+    unsigned int level;
+    while (zoneCount < MAX_ZONES && (level = getZoneLevel(zoneStart, memoryEnd)) >= MIN_LEVEL) {
+        Zone *zone = &zones[zoneCount++];
+        initializeZone(zone, zoneStart, level);
+        zoneStart = zone->heapStart + BLOCK_SIZE(level);
     }
 }
 
 void *
 malloc(size_t size) {
     unsigned int level;
-    if (size > HEAP_MEMORY_SIZE || size == 0 || (level = getLevel(size)) > MAX_LEVEL)
+    if (size == 0 || (level = getLevel(size)) > MAX_LEVEL)
         return NULL;
 
     if (level < MIN_LEVEL)
         level = MIN_LEVEL;
 
-    int index = getFirstFreeIndexOfLevel(level);
+    for (unsigned int i = 0; i < zoneCount; i++) {
+        if (level > zones[i].maxLevel)
+            continue;
 
-    if (index < 0)
-        return NULL;
-
-    updateParents(index, POSITIVE_DELTA);
-    setAsOccupied(index, TRUE);
-
-    memoryChunks++;
-    usedMemory += (1 << level);
+        int index = takeFreeBlock(&zones[i], level);
+        if (index >= 0) {
+            memoryChunks++;
+            usedMemory += BLOCK_SIZE(level);
+            return getAddress(&zones[i], index, level);
+        }
+    }
 
-    return getAddress(index, level);
+    return NULL;
 }
 
 int
@@ -178,31 +285,58 @@ free(void *ptr) {
     if (ptr == NULL)
         return 0;
 
-    if (ptr < heapStart || ptr >= (heapStart + HEAP_MEMORY_SIZE))
+    Zone *zone = findZone(ptr);
+    if (zone == NULL)
         return -1;
 
-    int level = getMaxPosibleLevel(ptr);
-    int index = searchNode(getStartSearchingIdx(ptr, level), &level, ptr);
+    unsigned int level;
+    int index = findAllocatedBlock(zone, ptr, &level);
 
     if (index < 0)
         return -1;
 
-    updateParents(index, NEGATIVE_DELTA);
-    setAsOccupied(index, FALSE);
+    releaseBlock(zone, index, level);
 
     memoryChunks--;
-    usedMemory -= (1 << level);
+    usedMemory -= BLOCK_SIZE(level);
 
     return 0;
 }
 
 void *
 realloc(void *ptr, size_t size) {
-    void *newPtr = malloc(size);
+    if (ptr == NULL)
+        return malloc(size);
+
+    if (size == 0) {
+        free(ptr);
+        return NULL;
+    }
+
+    Zone *zone = findZone(ptr);
+    unsigned int level, newLevel;
+    int index;
+    if (zone == NULL || (index = findAllocatedBlock(zone, ptr, &level)) < 0 || (newLevel = getLevel(size)) > MAX_LEVEL)
+        return NULL;
 
+    if (newLevel < MIN_LEVEL)
+        newLevel = MIN_LEVEL;
+
+    // Shrink by splitting, or grow by merging with free buddies, both keeping the address.
+    if (newLevel <= level) {
+        splitBlock(zone, index, level, newLevel);
+        usedMemory -= BLOCK_SIZE(level) - BLOCK_SIZE(newLevel);
+        return ptr;
+    }
+
+    if (growBlock(zone, index, level, newLevel)) {
+        usedMemory += BLOCK_SIZE(newLevel) - BLOCK_SIZE(level);
+        return ptr;
+    }
+
+    void *newPtr = malloc(size);
     if (newPtr != NULL) {
-        if (ptr >= heapStart)
-            memcpy(newPtr, ptr, size);
+        memcpy(newPtr, ptr, BLOCK_SIZE(level));
         free(ptr);
     }
 
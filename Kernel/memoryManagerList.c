@@ -1,92 +1,215 @@
-#ifndef USE_BUDDY
+#if !defined(USE_BUDDY) && !defined(USE_TLSF)
 
 #include <defs.h>
 #include <lib.h>
 #include <memoryManager.h>
 
-typedef struct memoryListNode {
-    size_t size;
-    size_t leftoverSize;
-    struct memoryListNode *previous;
-    struct memoryListNode *next;
+/*
+ * Every block starts with a header and ends with a footer holding its size, so both neighbours of a block can be
+ * found and merged when it is freed. Free blocks are kept in segregated lists, one per power of two size class.
+ */
+#define BLOCK_ALLOCATED   ((size_t) 1)
+#define BLOCK_SIZE(value) ((value) & ~BLOCK_ALLOCATED)
+#define HEADER_SIZE       sizeof(BlockHeader)
+#define FOOTER_SIZE       sizeof(size_t)
+#define MIN_BLOCK_SIZE    WORD_ALIGN_UP(sizeof(FreeBlock) + FOOTER_SIZE)
+
+// Class i holds the free blocks of size in [2^(i + MIN_CLASS_SHIFT), 2^(i + MIN_CLASS_SHIFT + 1)), the last one the rest
+#define SIZE_CLASSES    32
+#define MIN_CLASS_SHIFT 5
+#define CLASS_BIT(c)    ((uint64_t) 1 << (c))
+
+typedef struct {
+    size_t size;  // Size of the whole block, header and footer included, with BLOCK_ALLOCATED in the lowest bit
     size_t checksum;
-} MemoryListNode;
+} BlockHeader;
+
+typedef struct FreeBlock {
+    BlockHeader header;
+    struct FreeBlock *previous;
+    struct FreeBlock *next;
+} FreeBlock;
 
 static size_t totalMemory;
 static size_t usedMemory;
 static unsigned int memoryChunks;
 
-static MemoryListNode *firstBlock = NULL;
+static FreeBlock *freeLists[SIZE_CLASSES];
+static uint64_t nonEmptyClasses;
+
+static size_t
+calcBlockChecksum(const BlockHeader *block) {
+    return block->size ^ (size_t) block;
+}
+
+static inline BlockHeader *
+getNextBlock(const BlockHeader *block) {
+    return (void *) block + BLOCK_SIZE(block->size);
+}
+
+static inline size_t
+getPreviousFooter(const BlockHeader *block) {
+    return *(size_t *) ((void *) block - FOOTER_SIZE);
+}
+
+static void
+setBlock(BlockHeader *block, size_t size, size_t allocated) {
+    block->size = size | allocated;
+    block->checksum = calcBlockChecksum(block);
+    *(size_t *) ((void *) block + size - FOOTER_SIZE) = block->size;
+}
+
+static unsigned int
+getSizeClass(size_t size) {
+    int sizeClass = (63 - __builtin_clzl(size)) - MIN_CLASS_SHIFT;
+    if (sizeClass < 0)
+        return 0;
+    return sizeClass >= SIZE_CLASSES ? SIZE_CLASSES - 1 : sizeClass;
+}
+
+static void
+insertFreeBlock(FreeBlock *block) {
+    unsigned int sizeClass = getSizeClass(BLOCK_SIZE(block->header.size));
+    block->previous = NULL;
+    block->next = freeLists[sizeClass];
+    if (block->next != NULL)
+        block->next->previous = block;
+    freeLists[sizeClass] = block;
+    nonEmptyClasses |= CLASS_BIT(sizeClass);
+}
+
+static void
+removeFreeBlock(FreeBlock *block) {
+    unsigned int sizeClass = getSizeClass(BLOCK_SIZE(block->header.size));
+    if (block->previous == NULL)
+        freeLists[sizeClass] = block->next;
+    else
+        block->previous->next = block->next;
+
+    if (block->next != NULL)
+        block->next->previous = block->previous;
+
+    if (freeLists[sizeClass] == NULL)
+        nonEmptyClasses &= ~CLASS_BIT(sizeClass);
+}
+
+// First fit within the class of the size, otherwise any block of a larger class, which is large enough as a whole.
+static FreeBlock *
+findFreeBlock(size_t blockSize) {
+    unsigned int sizeClass = getSizeClass(blockSize);
+    for (FreeBlock *block = freeLists[sizeClass]; block != NULL; block = block->next) {
+        if (BLOCK_SIZE(block->header.size) >= blockSize)
+            return block;
+    }
+
+    uint64_t largerClasses = nonEmptyClasses & ~(CLASS_BIT(sizeClass + 1) - 1);
+    return largerClasses == 0 ? NULL : freeLists[__builtin_ctzl(largerClasses)];
+}
+
+// Frees a block that is in no list, merging it with its free neighbours.
+static void
+releaseBlock(BlockHeader *block) {
+    size_t size = BLOCK_SIZE(block->size);
+
+    BlockHeader *next = getNextBlock(block);
+    if ((next->size & BLOCK_ALLOCATED) == 0) {
+        removeFreeBlock((FreeBlock *) next);
+        size += BLOCK_SIZE(next->size);
+    }
+
+    size_t previousFooter = getPreviousFooter(block);
+    if ((previousFooter & BLOCK_ALLOCATED) == 0) {
+        block = (void *) block - BLOCK_SIZE(previousFooter);
+        removeFreeBlock((FreeBlock *) block);
+        size += BLOCK_SIZE(previousFooter);
+    }
+
+    setBlock(block, size, 0);
+    insertFreeBlock((FreeBlock *) block);
+}
 
+// Marks the first blockSize bytes of an unlisted block of availableSize bytes as allocated, freeing the rest.
 static void
-calcNodeChecksum(const MemoryListNode *node, size_t *result) {
-    *result = node->size ^ node->leftoverSize ^ (size_t) node->previous ^ (size_t) node->next;
+placeBlock(BlockHeader *block, size_t blockSize, size_t availableSize) {
+    if (availableSize - blockSize < MIN_BLOCK_SIZE) {
+        setBlock(block, availableSize, BLOCK_ALLOCATED);
+        return;
+    }
+
+    setBlock(block, blockSize, BLOCK_ALLOCATED);
+    BlockHeader *rest = getNextBlock(block);
+    setBlock(rest, availableSize - blockSize, BLOCK_ALLOCATED);
+    releaseBlock(rest);
+}
+
+static size_t
+getBlockSize(size_t size) {
+    size_t blockSize = WORD_ALIGN_UP(size) + HEADER_SIZE + FOOTER_SIZE;
+    return blockSize < MIN_BLOCK_SIZE ? MIN_BLOCK_SIZE : blockSize;
+}
+
+static BlockHeader *
+getAllocatedBlock(void *memorySegment) {
+    BlockHeader *block = (BlockHeader *) (memorySegment - HEADER_SIZE);
+    if (block->checksum != calcBlockChecksum(block) || (block->size & BLOCK_ALLOCATED) == 0)
+        return NULL;
+    return block;
 }
 
 void
 initializeMemory(void *memoryStart, size_t memorySize) {
+    totalMemory = 0;
+    usedMemory = 0;
+    memoryChunks = 0;
+
+    for (int i = 0; i < SIZE_CLASSES; i++)
+        freeLists[i] = NULL;
+    nonEmptyClasses = 0;
+
+    addMemory(memoryStart, memorySize);
+}
+
+void
+addMemory(void *memoryStart, size_t memorySize) {
     void *actualStart = (void *) WORD_ALIGN_UP(memoryStart);
+    if (memorySize < (actualStart - memoryStart) + FOOTER_SIZE + MIN_BLOCK_SIZE + HEADER_SIZE)
+        return;
+
     memorySize -= (actualStart - memoryStart);
     memorySize = WORD_ALIGN_DOWN(memorySize);
 
-    totalMemory = memorySize;
-    usedMemory = sizeof(MemoryListNode);
-    memoryChunks = 1;
+    // The segment is fenced by what looks like the footer and the header of allocated blocks, so no merge crosses it.
+    *(size_t *) actualStart = BLOCK_ALLOCATED;
+    BlockHeader *block = actualStart + FOOTER_SIZE;
+    size_t blockSize = memorySize - FOOTER_SIZE - HEADER_SIZE;
+
+    BlockHeader *epilogue = (void *) block + blockSize;
+    epilogue->size = BLOCK_ALLOCATED;
+    epilogue->checksum = 0;
 
-    firstBlock = (MemoryListNode *) actualStart;
-    memorySize -= sizeof(MemoryListNode);
+    setBlock(block, blockSize, 0);
+    insertFreeBlock((FreeBlock *) block);
 
-    firstBlock->size = 0;
-    firstBlock->leftoverSize = memorySize;
-    firstBlock->previous = NULL;
-    firstBlock->next = NULL;
-    calcNodeChecksum(firstBlock, &firstBlock->checksum);
+    totalMemory += memorySize;
+    usedMemory += FOOTER_SIZE + HEADER_SIZE;
 }
 
 void *
 malloc(size_t size) {
-    if (firstBlock == NULL || size == 0)
+    if (size == 0 || size > totalMemory)
         return NULL;
 
-    size = WORD_ALIGN_UP(size);
-
-    MemoryListNode *node = firstBlock;
-    size_t totalSizeWithNode = size + sizeof(MemoryListNode);
-
-    while ((node->size != 0 || node->leftoverSize < size) && node->leftoverSize < totalSizeWithNode) {
-        node = node->next;
-
-        if (node == NULL)
-            return NULL;
-    }
-
-    if (node->size == 0) {
-        node->size = size;
-        node->leftoverSize -= size;
-        calcNodeChecksum(node, &node->checksum);
-        usedMemory += size;
-        return (void *) node + sizeof(MemoryListNode);
-    }
-
-    MemoryListNode *newNode = (MemoryListNode *) ((void *) node + sizeof(MemoryListNode) + node->size);
-    newNode->size = size;
-    newNode->leftoverSize = node->leftoverSize - sizeof(MemoryListNode) - newNode->size;
-    newNode->previous = node;
-    newNode->next = node->next;
-    node->leftoverSize = 0;
-    node->next = newNode;
-
-    if (newNode->next != NULL) {
-        newNode->next->previous = newNode;
-        calcNodeChecksum(newNode->next, &newNode->next->checksum);
-    }
+    size_t blockSize = getBlockSize(size);
+    FreeBlock *block = findFreeBlock(blockSize);
+    if (block == NULL)
+        return NULL;
 
-    calcNodeChecksum(newNode, &newNode->checksum);
-    calcNodeChecksum(node, &node->checksum);
+    removeFreeBlock(block);
+    placeBlock(&block->header, blockSize, BLOCK_SIZE(block->header.size));
 
     memoryChunks++;
-    usedMemory += totalSizeWithNode;
-    return (void *) newNode + sizeof(MemoryListNode);
+    usedMemory += BLOCK_SIZE(block->header.size);
+    return (void *) block + HEADER_SIZE;
 }
 
 int
@@ -94,38 +217,19 @@ free(void *memorySegment) {
     if (memorySegment == NULL)
         return 0;
 
-    MemoryListNode *node = (MemoryListNode *) (memorySegment - sizeof(MemoryListNode));
-
-    size_t checksum;
-    calcNodeChecksum(node, &checksum);
-    if (checksum != node->checksum)
+    BlockHeader *block = getAllocatedBlock(memorySegment);
+    if (block == NULL)
         return 1;
 
-    if (node->previous == NULL) {
-        node->leftoverSize += node->size;
-        node->size = 0;
-        usedMemory -= node->size;
-        calcNodeChecksum(node, &node->checksum);
-    } else {
-        node->previous->leftoverSize += node->size + node->leftoverSize + sizeof(MemoryListNode);
-        node->previous->next = node->next;
-        usedMemory -= node->size + sizeof(MemoryListNode);
-        memoryChunks--;
-        calcNodeChecksum(node->previous, &node->previous->checksum);
-
-        if (node->next != NULL) {
-            node->next->previous = node->previous;
-            calcNodeChecksum(node->next, &node->next->checksum);
-        }
-    }
+    memoryChunks--;
+    usedMemory -= BLOCK_SIZE(block->size);
+    releaseBlock(block);
 
     return 0;
 }
 
 void *
 realloc(void *memorySegment, size_t size) {
-    size = WORD_ALIGN_UP(size);
-
     if (memorySegment == NULL)
         return malloc(size);
 
@@ -134,36 +238,31 @@ realloc(void *memorySegment, size_t size) {
         return NULL;
     }
 
-    MemoryListNode *node = (MemoryListNode *) (memorySegment - sizeof(MemoryListNode));
-
-    size_t checksum;
-    calcNodeChecksum(node, &checksum);
-    if (checksum != node->checksum)
+    BlockHeader *block = getAllocatedBlock(memorySegment);
+    if (block == NULL || size > totalMemory)
         return NULL;
 
-    if (node->size == size)
-        return memorySegment;
+    size_t blockSize = getBlockSize(size);
+    size_t currentSize = BLOCK_SIZE(block->size);
+    BlockHeader *next = getNextBlock(block);
 
-    if (size < node->size) {
-        node->leftoverSize += node->size - size;
-        usedMemory -= node->size - size;
-        node->size = size;
-        calcNodeChecksum(node, &node->checksum);
-        return memorySegment;
+    // Shrink in place, or grow into the next block when it is free and large enough.
+    size_t availableSize = currentSize;
+    if (blockSize > currentSize && (next->size & BLOCK_ALLOCATED) == 0 &&
+        currentSize + BLOCK_SIZE(next->size) >= blockSize) {
+        removeFreeBlock((FreeBlock *) next);
+        availableSize += BLOCK_SIZE(next->size);
     }
 
-    size_t extraRequiredSize = size - node->size;
-    if (node->leftoverSize >= extraRequiredSize) {
-        node->leftoverSize -= extraRequiredSize;
-        node->size = size;
-        usedMemory += extraRequiredSize;
-        calcNodeChecksum(node, &node->checksum);
+    if (blockSize <= availableSize) {
+        placeBlock(block, blockSize, availableSize);
+        usedMemory += BLOCK_SIZE(block->size) - currentSize;
         return memorySegment;
     }
 
     void *newPtr = malloc(size);
     if (newPtr != NULL) {
-        memcpy(newPtr, memorySegment, node->size);
+        memcpy(newPtr, memorySegment, currentSize - HEADER_SIZE - FOOTER_SIZE);
         free(memorySegment);
     }
     return newPtr;
@@ -177,4 +276,4 @@ getStateMemory(MemoryState *memoryState) {
     return 0;
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,323 @@
+#ifdef USE_TLSF
+
+#include <defs.h>
+#include <lib.h>
+#include <memoryManager.h>
+
+/*
+ * Two-Level Segregated Fit. Free blocks are kept in lists indexed by the power of two of their size (first level)
+ * and by a linear subdivision of that power (second level). Bitmaps of the non-empty lists make finding a block
+ * that is large enough a matter of a couple of bit scans, so malloc() and free() run in constant time.
+ */
+#define SL_INDEX_LOG2  5
+#define SL_INDEX_COUNT (1 << SL_INDEX_LOG2)
+#define FL_INDEX_SHIFT (SL_INDEX_LOG2 + 3)
+#define FL_INDEX_MAX   37  // Blocks up to 128 GiB, past the 64 GiB Pure64 identity maps
+#define FL_INDEX_COUNT (FL_INDEX_MAX - FL_INDEX_SHIFT + 1)
+#define SMALL_BLOCK    (1UL << FL_INDEX_SHIFT)
+
+#define BLOCK_FREE          ((size_t) 1)
+#define BLOCK_PREVIOUS_FREE ((size_t) 2)
+#define BLOCK_SIZE(value)   ((value) & ~(BLOCK_FREE | BLOCK_PREVIOUS_FREE))
+#define HEADER_SIZE         sizeof(BlockHeader)
+#define FOOTER_SIZE         sizeof(size_t)
+#define MIN_BLOCK_SIZE      WORD_ALIGN_UP(sizeof(FreeBlock) + FOOTER_SIZE)
+#define MAX_BLOCK_SIZE      ((size_t) 1 << FL_INDEX_MAX)
+
+typedef struct {
+    size_t size;  // Size of the whole block, header included, with BLOCK_FREE and BLOCK_PREVIOUS_FREE in the low bits
+    size_t checksum;
+} BlockHeader;
+
+// Free blocks also keep their size in their last word, so the next block can find them when it is freed.
+typedef struct FreeBlock {
+    BlockHeader header;
+    struct FreeBlock *previous;
+    struct FreeBlock *next;
+} FreeBlock;
+
+static size_t totalMemory;
+static size_t usedMemory;
+static unsigned int memoryChunks;
+
+static uint64_t firstLevelBitmap;
+static uint32_t secondLevelBitmaps[FL_INDEX_COUNT];
+static FreeBlock *freeLists[FL_INDEX_COUNT][SL_INDEX_COUNT];
+
+static inline int
+getLastBit(size_t value) {
+    return 63 - __builtin_clzl(value);
+}
+
+static size_t
+calcBlockChecksum(const BlockHeader *block) {
+    return BLOCK_SIZE(block->size) ^ (size_t) block;
+}
+
+static inline BlockHeader *
+getNextBlock(const BlockHeader *block) {
+    return (void *) block + BLOCK_SIZE(block->size);
+}
+
+static void
+setBlock(BlockHeader *block, size_t size, size_t flags) {
+    block->size = size | flags;
+    block->checksum = calcBlockChecksum(block);
+}
+
+static void
+mapping(size_t size, int *firstLevel, int *secondLevel) {
+    if (size < SMALL_BLOCK) {
+        *firstLevel = 0;
+        *secondLevel = size / (SMALL_BLOCK / SL_INDEX_COUNT);
+        return;
+    }
+
+    int lastBit = getLastBit(size);
+    *firstLevel = lastBit - (FL_INDEX_SHIFT - 1);
+    *secondLevel = (size >> (lastBit - SL_INDEX_LOG2)) ^ SL_INDEX_COUNT;
+}
+
+// Rounds the size up to the next list boundary, so every block of the list it maps to is large enough.
+static void
+mappingSearch(size_t size, int *firstLevel, int *secondLevel) {
+    if (size >= SMALL_BLOCK)
+        size += ((size_t) 1 << (getLastBit(size) - SL_INDEX_LOG2)) - 1;
+    mapping(size, firstLevel, secondLevel);
+}
+
+static FreeBlock *
+findSuitableBlock(int firstLevel, int secondLevel) {
+    if (firstLevel >= FL_INDEX_COUNT)
+        return NULL;
+
+    uint32_t secondLevelMap = secondLevelBitmaps[firstLevel] & (~(uint32_t) 0 << secondLevel);
+    if (secondLevelMap == 0) {
+        uint64_t firstLevelMap = firstLevelBitmap & (~(uint64_t) 0 << (firstLevel + 1));
+        if (firstLevelMap == 0)
+            return NULL;
+
+        firstLevel = __builtin_ctzl(firstLevelMap);
+        secondLevelMap = secondLevelBitmaps[firstLevel];
+    }
+
+    return freeLists[firstLevel][__builtin_ctz(secondLevelMap)];
+}
+
+static void
+insertFreeBlock(FreeBlock *block, size_t size) {
+    int firstLevel, secondLevel;
+    mapping(size, &firstLevel, &secondLevel);
+
+    block->previous = NULL;
+    block->next = freeLists[firstLevel][secondLevel];
+    if (block->next != NULL)
+        block->next->previous = block;
+    freeLists[firstLevel][secondLevel] = block;
+    firstLevelBitmap |= (uint64_t) 1 << firstLevel;
+    secondLevelBitmaps[firstLevel] |= (uint32_t) 1 << secondLevel;
+
+    // Keep the previous flag, mark the block as free and let the next block know.
+    setBlock(&block->header, size, (block->header.size & BLOCK_PREVIOUS_FREE) | BLOCK_FREE);
+    *(size_t *) ((void *) block + size - FOOTER_SIZE) = size;
+    getNextBlock(&block->header)->size |= BLOCK_PREVIOUS_FREE;
+}
+
+static void
+removeFreeBlock(FreeBlock *block) {
+    int firstLevel, secondLevel;
+    mapping(BLOCK_SIZE(block->header.size), &firstLevel, &secondLevel);
+
+    if (block->previous == NULL)
+        freeLists[firstLevel][secondLevel] = block->next;
+    else
+        block->previous->next = block->next;
+
+    if (block->next != NULL)
+        block->next->previous = block->previous;
+
+    if (freeLists[firstLevel][secondLevel] == NULL) {
+        secondLevelBitmaps[firstLevel] &= ~((uint32_t) 1 << secondLevel);
+        if (secondLevelBitmaps[firstLevel] == 0)
+            firstLevelBitmap &= ~((uint64_t) 1 << firstLevel);
+    }
+
+    getNextBlock(&block->header)->size &= ~BLOCK_PREVIOUS_FREE;
+}
+
+// Frees a block that is in no list, merging it with its free neighbours.
+static void
+releaseBlock(BlockHeader *block) {
+    size_t size = BLOCK_SIZE(block->size);
+
+    BlockHeader *next = getNextBlock(block);
+    if (next->size & BLOCK_FREE) {
+        removeFreeBlock((FreeBlock *) next);
+        size += BLOCK_SIZE(next->size);
+    }
+
+    if (block->size & BLOCK_PREVIOUS_FREE) {
+        size_t previousSize = *(size_t *) ((void *) block - FOOTER_SIZE);
+        block = (void *) block - previousSize;
+        removeFreeBlock((FreeBlock *) block);
+        size += previousSize;
+    }
+
+    insertFreeBlock((FreeBlock *) block, size);
+}
+
+// Marks the first blockSize bytes of an unlisted block of availableSize bytes as allocated, freeing the rest.
+static void
+placeBlock(BlockHeader *block, size_t blockSize, size_t availableSize) {
+    size_t previousFree = block->size & BLOCK_PREVIOUS_FREE;
+
+    if (availableSize - blockSize < MIN_BLOCK_SIZE) {
+        setBlock(block, availableSize, previousFree);
+        return;
+    }
+
+    setBlock(block, blockSize, previousFree);
+    BlockHeader *rest = getNextBlock(block);
+    setBlock(rest, availableSize - blockSize, 0);
+    releaseBlock(rest);
+}
+
+static size_t
+getBlockSize(size_t size) {
+    size_t blockSize = WORD_ALIGN_UP(size) + HEADER_SIZE;
+    return blockSize < MIN_BLOCK_SIZE ? MIN_BLOCK_SIZE : blockSize;
+}
+
+static BlockHeader *
+getAllocatedBlock(void *memorySegment) {
+    BlockHeader *block = (BlockHeader *) (memorySegment - HEADER_SIZE);
+    if (block->checksum != calcBlockChecksum(block) || (block->size & BLOCK_FREE) != 0 || BLOCK_SIZE(block->size) == 0)
+        return NULL;
+    return block;
+}
+
+void
+initializeMemory(void *memoryStart, size_t memorySize) {
+    totalMemory = 0;
+    usedMemory = 0;
+    memoryChunks = 0;
+
+    firstLevelBitmap = 0;
+    for (int i = 0; i < FL_INDEX_COUNT; i++) {
+        secondLevelBitmaps[i] = 0;
+        for (int j = 0; j < SL_INDEX_COUNT; j++)
+            freeLists[i][j] = NULL;
+    }
+
+    addMemory(memoryStart, memorySize);
+}
+
+void
+addMemory(void *memoryStart, size_t memorySize) {
+    void *actualStart = (void *) WORD_ALIGN_UP(memoryStart);
+    if (memorySize < (actualStart - memoryStart) + MIN_BLOCK_SIZE + HEADER_SIZE)
+        return;
+
+    memorySize -= (actualStart - memoryStart);
+    memorySize = WORD_ALIGN_DOWN(memorySize);
+
+    // No block merged within the segment can then grow past what the lists index.
+    if (memorySize > MAX_BLOCK_SIZE)
+        memorySize = MAX_BLOCK_SIZE;
+
+    // The segment ends with an empty allocated block, so no merge crosses it.
+    BlockHeader *block = actualStart;
+    size_t blockSize = memorySize - HEADER_SIZE;
+    setBlock(block, blockSize, 0);
+    setBlock(getNextBlock(block), 0, 0);
+    insertFreeBlock((FreeBlock *) block, blockSize);
+
+    totalMemory += memorySize;
+    usedMemory += HEADER_SIZE;
+}
+
+void *
+malloc(size_t size) {
+    if (size == 0 || size > totalMemory)
+        return NULL;
+
+    size_t blockSize = getBlockSize(size);
+    int firstLevel, secondLevel;
+    mappingSearch(blockSize, &firstLevel, &secondLevel);
+
+    FreeBlock *block = findSuitableBlock(firstLevel, secondLevel);
+    if (block == NULL)
+        return NULL;
+
+    removeFreeBlock(block);
+    placeBlock(&block->header, blockSize, BLOCK_SIZE(block->header.size));
+
+    memoryChunks++;
+    usedMemory += BLOCK_SIZE(block->header.size);
+    return (void *) block + HEADER_SIZE;
+}
+
+int
+free(void *memorySegment) {
+    if (memorySegment == NULL)
+        return 0;
+
+    BlockHeader *block = getAllocatedBlock(memorySegment);
+    if (block == NULL)
+        return 1;
+
+    memoryChunks--;
+    usedMemory -= BLOCK_SIZE(block->size);
+    releaseBlock(block);
+
+    return 0;
+}
+
+void *
+realloc(void *memorySegment, size_t size) {
+    if (memorySegment == NULL)
+        return malloc(size);
+
+    if (size == 0) {
+        free(memorySegment);
+        return NULL;
+    }
+
+    BlockHeader *block = getAllocatedBlock(memorySegment);
+    if (block == NULL || size > totalMemory)
+        return NULL;
+
+    size_t blockSize = getBlockSize(size);
+    size_t currentSize = BLOCK_SIZE(block->size);
+    BlockHeader *next = getNextBlock(block);
+
+    // Shrink in place, or grow into the next block when it is free and large enough.
+    size_t availableSize = currentSize;
+    if (blockSize > currentSize && (next->size & BLOCK_FREE) && currentSize + BLOCK_SIZE(next->size) >= blockSize) {
+        removeFreeBlock((FreeBlock *) next);
+        availableSize += BLOCK_SIZE(next->size);
+    }
+
+    if (blockSize <= availableSize) {
+        placeBlock(block, blockSize, availableSize);
+        usedMemory += BLOCK_SIZE(block->size) - currentSize;
+        return memorySegment;
+    }
+
+    void *newPtr = malloc(size);
+    if (newPtr != NULL) {
+        memcpy(newPtr, memorySegment, currentSize - HEADER_SIZE);
+        free(memorySegment);
+    }
+    return newPtr;
+}
+
+int
+getStateMemory(MemoryState *memoryState) {
+    memoryState->total = totalMemory;
+    memoryState->used = usedMemory;
+    memoryState->type = TLSF;
+    return 0;
+}
+
+#endif
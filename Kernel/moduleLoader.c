@@ -2,25 +2,32 @@
 #include <lib.h>
 #include <moduleLoader.h>
 
-static void loadModule(uint8_t **module, void *targetModuleAddress);
+static void *loadModule(uint8_t **module, void *targetModuleAddress);
 static uint32_t readUint32(uint8_t **address);
 
-void
+void *
 loadModules(void *payloadStart, void **targetModuleAddress) {
     int i;
     uint8_t *currentModule = (uint8_t *) payloadStart;
     uint32_t moduleCount = readUint32(&currentModule);
+    void *modulesEnd = NULL;
 
-    for (i = 0; i < moduleCount; i++)
-        loadModule(&currentModule, targetModuleAddress[i]);
+    for (i = 0; i < moduleCount; i++) {
+        void *moduleEnd = loadModule(&currentModule, targetModuleAddress[i]);
+        if (moduleEnd > modulesEnd)
+            modulesEnd = moduleEnd;
+    }
+
+    return modulesEnd;
 }
 
-static void
+static void *
 loadModule(uint8_t **module, void *targetModuleAddress) {
     uint32_t moduleSize = readUint32(module);
 
     memcpy(targetModuleAddress, *module, moduleSize);
     *module += moduleSize;
+    return targetModuleAddress + moduleSize;
 }
 
 static uint32_t
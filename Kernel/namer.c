@@ -1,6 +1,7 @@
 #include <defs.h>
 #include <memoryManager.h>
 #include <namer.h>
+#include <slab.h>
 #include <string.h>
 
 #define BUFFER_CHUNK_SIZE 8
@@ -16,6 +17,20 @@ struct NamerData {
     int bufferSize;
 };
 
+// Valid names are never longer than MAX_NAME_LENGTH, so every copy fits in an object of this type.
+typedef char NameCopy[MAX_NAME_LENGTH + 1];
+
+static void
+resetNamer(void *namer) {
+    Namer namerData = namer;
+    namerData->resources = NULL;
+    namerData->count = 0;
+    namerData->bufferSize = 0;
+}
+
+static ObjectCache namerCache = OBJECT_CACHE(struct NamerData, resetNamer);
+static ObjectCache nameCache = OBJECT_CACHE(NameCopy, NULL);
+
 static int
 isValidName(const char *name) {
     if (name == NULL)
@@ -38,20 +53,14 @@ isValidName(const char *name) {
 
 Namer
 newNamer() {
-    Namer namer = malloc(sizeof(struct NamerData));
-
-    if (namer != NULL) {
-        namer->resources = NULL;
-        namer->count = 0;
-        namer->bufferSize = 0;
-    }
-
-    return namer;
+    return allocateObject(&namerCache);
 }
 
 int
 freeNamer(Namer namer) {
-    return free(namer->resources) + free(namer);
+    int result = free(namer->resources);
+    resetNamer(namer);
+    return result + freeObject(&namerCache, namer);
 }
 
 static int
@@ -75,7 +84,7 @@ addResource(Namer namer, void *resource, const char *name, const char **nameData
     if (c == 0)
         return 1;
 
-    char *nameCopy = malloc(strlen(name) + 1);
+    char *nameCopy = allocateObject(&nameCache);
     if (nameCopy == NULL)
         return -1;
 
@@ -84,7 +93,7 @@ addResource(Namer namer, void *resource, const char *name, const char **nameData
         size_t newBufferSize = namer->bufferSize + BUFFER_CHUNK_SIZE;
         NamedResource *newBuffer = realloc(namer->resources, newBufferSize * sizeof(NamedResource));
         if (newBuffer == NULL) {
-            free(nameCopy);
+            freeObject(&nameCache, nameCopy);
             return -1;
         }
 
@@ -113,7 +122,7 @@ deleteResource(Namer namer, const char *name) {
     if (c != 0)
         return NULL;
 
-    free(namer->resources[index].name);
+    freeObject(&nameCache, namer->resources[index].name);
     namer->count--;
 
     for (; index < namer->count; index++)
@@ -5,6 +5,7 @@
 #include <pipe.h>
 #include <process.h>
 #include <scheduler.h>
+#include <slab.h>
 #include <string.h>
 #include <waitingQueue.h>
 
@@ -28,6 +29,9 @@ typedef struct {
     int allowRead, allowWrite;
 } PipeFdMapping;
 
+static ObjectCache pipeCache = OBJECT_CACHE(PipeData, NULL);
+static ObjectCache mappingCache = OBJECT_CACHE(PipeFdMapping, NULL);
+
 static PipeData *pipes[MAX_PIPES];
 static int nextCandidate = 0;
 static Namer namedPipes = NULL;
@@ -59,10 +63,11 @@ createPipe() {
     PipeData *pipeData;
     WaitingQueue readQueue = NULL;
     WaitingQueue writeQueue = NULL;
-    if ((pipeData = malloc(sizeof(PipeData))) == NULL || (readQueue = newQueue()) == NULL || (writeQueue = newQueue()) == NULL) {
-        free(pipeData);
+    if ((pipeData = allocateObject(&pipeCache)) == NULL || (readQueue = newQueue()) == NULL ||
+        (writeQueue = newQueue()) == NULL) {
+        freeObject(&pipeCache, pipeData);
         if (readQueue != NULL)
-            free(readQueue);
+            freeQueue(readQueue);
         return -1;
     }
 
@@ -126,7 +131,8 @@ freePipe(Pipe pipe) {
         return 1;
 
     pipes[pipe] = NULL;
-    return free(pipeData->buffer) + freeQueue(pipeData->readProcessWQ) + freeQueue(pipeData->writeProcessWQ) + free(pipeData);
+    return free(pipeData->buffer) + freeQueue(pipeData->readProcessWQ) + freeQueue(pipeData->writeProcessWQ) +
+           freeObject(&pipeCache, pipeData);
 }
 
 static ssize_t
@@ -225,14 +231,14 @@ addFdPipe(Pid pid, int fd, Pipe pipe, int allowRead, int allowWrite) {
     if (pipeData == NULL)
         return -1;
 
-    PipeFdMapping *mapping = malloc(sizeof(PipeFdMapping));
+    PipeFdMapping *mapping = allocateObject(&mappingCache);
     if (mapping == NULL)
         return -1;
 
     int r =
         addFd(pid, fd, mapping, allowRead ? &readHandler : NULL, allowWrite ? &writeHandler : NULL, &closeHandler, &dupHandler);
     if (r < 0) {
-        free(mapping);
+        freeObject(&mappingCache, mapping);
         return r;
     }
 
@@ -256,13 +262,18 @@ readHandler(Pid pid, int fd, void *resource, char *buf, size_t count) {
     if (count == 0)
         return 0;
 
+    // Interrupts are off during system calls, so the writer peeked is the one readData() wakes up.
     ssize_t r;
+    Pid writer = peekInQueue(pipe->writeProcessWQ);
     while ((r = readData(pipe, buf, count)) == 0 && (pipe->name != NULL || pipe->writerFdCount != 0)) {
         addInQueue(pipe->readProcessWQ, pid);
         block(pid);
         yield();
+        writer = peekInQueue(pipe->writeProcessWQ);
     }
 
+    if (r > 0)
+        yieldTo(writer);
     return r;
 }
 
@@ -274,13 +285,18 @@ writeHandler(Pid pid, int fd, void *resource, const char *buf, size_t count) {
     if (count == 0)
         return 0;
 
+    // Interrupts are off during system calls, so the reader peeked is the one writeData() wakes up.
     ssize_t r;
+    Pid reader = peekInQueue(pipe->readProcessWQ);
     while ((r = writeData(pipe, buf, count)) == 0 && (pipe->name != NULL || pipe->readerFdCount != 0)) {
         addInQueue(pipe->writeProcessWQ, pid);
         block(pid);
         yield();
+        reader = peekInQueue(pipe->readProcessWQ);
     }
 
+    if (r > 0)
+        yieldTo(reader);
     return r == 0 ? -1 : r;
 }
 
@@ -291,7 +307,7 @@ closeHandler(Pid pid, int fd, void *resource) {
 
     pipe->readerFdCount -= mapping->allowRead;
     pipe->writerFdCount -= mapping->allowWrite;
-    int result = free(mapping);
+    int result = freeObject(&mappingCache, mapping);
 
     if (pipe->name == NULL) {
         if (pipe->readerFdCount == 0) {
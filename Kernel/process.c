@@ -10,9 +10,12 @@
 
 #define FD_TABLE_CHUNK_SIZE  8
 #define FD_TABLE_MAX_ENTRIES 64
-#define MEM_TABLE_CHUNK_SIZE 16
+#define MEM_TABLE_MIN_SIZE   16  // Must be a power of two
 #define MAX_NAME_LENGTH      16
 
+#define PROCESS_TABLE_MIN_SIZE 16
+#define NO_SLOT                -1
+
 typedef struct {
     void *resource;
     ReadHandler readHandler;
@@ -22,32 +25,93 @@ typedef struct {
 } FDEntry;
 
 typedef struct {
+    Pid pid;
+    unsigned int generation;
+    int nextFreeSlot;
     void *stackEnd;
     void *stackStart;
     int isForeground;
     char *name;
     FDEntry *fdTable;
     unsigned int fdTableSize;
-    void **memory;
+    void **memory;  // Open addressing hash set of the allocations of the process, NULL marking empty entries
     unsigned int memoryCount, memoryBufSize;
     char **argv;
     int argc;
     WaitingQueue pidWQ;
 } Process;
 
-static Process processes[MAX_PROCESSES];
+static Process *processes = NULL;
+static unsigned int processTableSize = 0;
+
+// Free slots are kept in a FIFO list, so a slot is reused as late as possible.
+static int firstFreeSlot = NO_SLOT;
+static int lastFreeSlot = NO_SLOT;
 
 static int deleteFdUnchecked(Process *process, Pid pid, int fd);
 
 static int
 getProcessByPid(Pid pid, Process **outProcess) {
-    if (pid < 0 || pid >= MAX_PROCESSES || processes[pid].stackEnd == NULL)
+    if (pid < 0 || PID_TO_SLOT(pid) >= processTableSize)
         return 0;
 
-    *outProcess = &processes[pid];
+    Process *process = &processes[PID_TO_SLOT(pid)];
+    if (process->stackEnd == NULL || process->pid != pid)
+        return 0;
+
+    *outProcess = process;
     return 1;
 }
 
+static void
+releaseSlot(int slot) {
+    processes[slot].nextFreeSlot = NO_SLOT;
+
+    if (lastFreeSlot == NO_SLOT)
+        firstFreeSlot = slot;
+    else
+        processes[lastFreeSlot].nextFreeSlot = slot;
+
+    lastFreeSlot = slot;
+}
+
+static int
+growProcessTable() {
+    if (processTableSize == MAX_PROCESSES)
+        return 1;
+
+    // Grow geometrically so that creating many processes costs amortized O(1) copies.
+    unsigned int newSize = processTableSize == 0 ? PROCESS_TABLE_MIN_SIZE : processTableSize * 2;
+    if (newSize > MAX_PROCESSES)
+        newSize = MAX_PROCESSES;
+
+    Process *newTable = realloc(processes, newSize * sizeof(Process));
+    if (newTable == NULL)
+        return 1;
+
+    memset(&newTable[processTableSize], 0, (newSize - processTableSize) * sizeof(Process));
+    processes = newTable;
+
+    for (unsigned int slot = processTableSize; slot < newSize; slot++)
+        releaseSlot(slot);
+
+    processTableSize = newSize;
+    return 0;
+}
+
+static int
+allocateSlot() {
+    if (firstFreeSlot == NO_SLOT && growProcessTable() != 0)
+        return NO_SLOT;
+
+    int slot = firstFreeSlot;
+    firstFreeSlot = processes[slot].nextFreeSlot;
+    if (firstFreeSlot == NO_SLOT)
+        lastFreeSlot = NO_SLOT;
+
+    return slot;
+}
+
 static int
 isValidName(const char *name) {
     if (name == NULL)
@@ -66,13 +130,14 @@ isValidName(const char *name) {
 
     return 0;
 }
+
 Pid
 createProcess(const ProcessCreateInfo *createInfo) {
-    Pid pid = 0;
-    for (; pid < MAX_PROCESSES && processes[pid].stackEnd != NULL; pid++)
-        ;
+    if (createInfo->argc < 0 || !isValidName(createInfo->name))
+        return -1;
 
-    if (createInfo->argc < 0 || pid == MAX_PROCESSES || !isValidName(createInfo->name))
+    int slot = allocateSlot();
+    if (slot == NO_SLOT)
         return -1;
 
     void *stackEnd = NULL;
@@ -82,6 +147,7 @@ createProcess(const ProcessCreateInfo *createInfo) {
         (createInfo->argc != 0 && (argvCopy = malloc(sizeof(char *) * createInfo->argc)) == NULL)) {
         free(stackEnd);
         free(nameCopy);
+        releaseSlot(slot);
         return -1;
     }
 
@@ -96,6 +162,7 @@ createProcess(const ProcessCreateInfo *createInfo) {
                 free(argvCopy[i]);
             }
             free(argvCopy);
+            releaseSlot(slot);
             return -1;
         }
 
@@ -104,9 +171,13 @@ createProcess(const ProcessCreateInfo *createInfo) {
 
     strcpy(nameCopy, createInfo->name);
 
-    Process *process = &processes[pid];
+    Process *process = &processes[slot];
+    unsigned int generation = process->generation;
+    Pid pid = MAKE_PID(slot, generation);
 
     memset(process, 0, sizeof(Process));
+    process->pid = pid;
+    process->generation = generation;
     process->stackEnd = stackEnd;
     process->stackStart = stackEnd + PROCESS_STACK_SIZE;
     process->isForeground = createInfo->isForeground;
@@ -114,8 +185,11 @@ createProcess(const ProcessCreateInfo *createInfo) {
     process->argv = argvCopy;
     process->argc = createInfo->argc;
 
-    onProcessCreated(pid, createInfo->start, createInfo->priority, process->stackStart, createInfo->argc,
-                     (const char *const *) argvCopy);
+    if (onProcessCreated(pid, createInfo->start, createInfo->priority, process->stackStart, createInfo->argc,
+                         (const char *const *) argvCopy) != 0) {
+        kill(pid);
+        return -1;
+    }
 
     return pid;
 }
@@ -130,7 +204,7 @@ kill(Pid pid) {
         if (process->fdTable[fd].resource != NULL)
             deleteFdUnchecked(process, pid, fd);
 
-    for (int i = 0; i < process->memoryCount; i++)
+    for (int i = 0; i < process->memoryBufSize; i++)
         free(process->memory[i]);
     free(process->memory);
 
@@ -149,31 +223,97 @@ kill(Pid pid) {
     free(process->stackEnd);
     free(process->name);
     free(process->fdTable);
+
+    // Bump the slot generation so the PID of the dead process is not mistaken for the next one using this slot.
+    unsigned int generation = process->generation;
     memset(process, 0, sizeof(Process));
+    process->generation = generation == MAX_PID_GENERATION ? 0 : generation + 1;
+    releaseSlot(PID_TO_SLOT(pid));
+
+    return 0;
+}
+
+static unsigned int
+getMemoryHash(const Process *process, void *ptr) {
+    return (((uint64_t) ptr >> 3) * 0x9E3779B97F4A7C15UL >> 32) & (process->memoryBufSize - 1);
+}
+
+static int
+findMemoryIndex(const Process *process, void *ptr) {
+    if (ptr == NULL || process->memoryBufSize == 0)
+        return -1;
 
+    for (int i = getMemoryHash(process, ptr); process->memory[i] != NULL; i = (i + 1) & (process->memoryBufSize - 1)) {
+        if (process->memory[i] == ptr)
+            return i;
+    }
+
+    return -1;
+}
+
+static void
+insertMemory(Process *process, void *ptr) {
+    int i = getMemoryHash(process, ptr);
+    while (process->memory[i] != NULL)
+        i = (i + 1) & (process->memoryBufSize - 1);
+
+    process->memory[i] = ptr;
+    process->memoryCount++;
+}
+
+static void
+removeMemoryAt(Process *process, int index) {
+    unsigned int mask = process->memoryBufSize - 1;
+    process->memory[index] = NULL;
+    process->memoryCount--;
+
+    // Move back every later entry of the run whose probe sequence went through the emptied entry.
+    for (int i = (index + 1) & mask; process->memory[i] != NULL; i = (i + 1) & mask) {
+        unsigned int home = getMemoryHash(process, process->memory[i]);
+        if (((i - home) & mask) >= ((i - index) & mask)) {
+            process->memory[index] = process->memory[i];
+            process->memory[i] = NULL;
+            index = i;
+        }
+    }
+}
+
+// Keeps the table at most three quarters full, so there is always room for one more allocation.
+static int
+reserveMemoryEntry(Process *process) {
+    if ((process->memoryCount + 1) * 4 <= process->memoryBufSize * 3)
+        return 0;
+
+    unsigned int oldBufSize = process->memoryBufSize;
+    void **oldMemory = process->memory;
+    unsigned int newBufSize = oldBufSize == 0 ? MEM_TABLE_MIN_SIZE : oldBufSize * 2;
+    void **newMemory = malloc(newBufSize * sizeof(void *));
+    if (newMemory == NULL)
+        return 1;
+
+    memset(newMemory, 0, newBufSize * sizeof(void *));
+    process->memory = newMemory;
+    process->memoryBufSize = newBufSize;
+    process->memoryCount = 0;
+
+    for (int i = 0; i < oldBufSize; i++)
+        if (oldMemory[i] != NULL)
+            insertMemory(process, oldMemory[i]);
+
+    free(oldMemory);
     return 0;
 }
 
 void *
 handleMalloc(Pid pid, size_t size) {
     Process *process;
-    if (!getProcessByPid(pid, &process))
+    if (!getProcessByPid(pid, &process) || reserveMemoryEntry(process))
         return NULL;
 
-    if (process->memoryBufSize == process->memoryCount) {
-        size_t newBufSize = process->memoryBufSize + MEM_TABLE_CHUNK_SIZE;
-        void **newMemory = realloc(process->memory, newBufSize * sizeof(Process));
-        if (newMemory == NULL)
-            return NULL;
-
-        process->memory = newMemory;
-        process->memoryBufSize = newBufSize;
-    }
-
     void *ptr = malloc(size);
 
     if (ptr != NULL)
-        process->memory[process->memoryCount++] = ptr;
+        insertMemory(process, ptr);
 
     return ptr;
 }
@@ -184,21 +324,11 @@ handleFree(Pid pid, void *memorySegment) {
     if (!getProcessByPid(pid, &process))
         return 1;
 
-    int index = -1;
-    for (int i = 0; i < process->memoryCount; i++) {
-        if (process->memory[i] == memorySegment) {
-            index = i;
-            break;
-        }
-    }
-
+    int index = findMemoryIndex(process, memorySegment);
     if (index == -1)
         return 1;
 
-    process->memoryCount--;
-    for (int i = index; i < process->memoryCount; i++)
-        process->memory[i] = process->memory[i + 1];
-
+    removeMemoryAt(process, index);
     return free(memorySegment);
 }
 
@@ -208,21 +338,19 @@ handleRealloc(Pid pid, void *memorySegment, size_t size) {
     if (!getProcessByPid(pid, &process))
         return NULL;
 
-    int index = -1;
-    for (int i = 0; i < process->memoryCount; i++) {
-        if (process->memory[i] == memorySegment) {
-            index = i;
-            break;
-        }
-    }
-
+    int index = findMemoryIndex(process, memorySegment);
     if (index == -1)
         return NULL;
 
     void *newPtr = realloc(memorySegment, size);
 
-    if (newPtr != NULL)
-        process->memory[index] = newPtr;
+    // A size of 0 frees the segment.
+    if (size == 0)
+        removeMemoryAt(process, index);
+    else if (newPtr != NULL && newPtr != memorySegment) {
+        removeMemoryAt(process, index);
+        insertMemory(process, newPtr);
+    }
 
     return newPtr;
 }
@@ -364,21 +492,23 @@ unblockOnKilled(Pid pidToUnblock, Pid pidToWait) {
     return 0;
 }
 
-uint8_t
-listProcesses(ProcessInfo *storingInfo, uint8_t maxProcesses) {
+int
+listProcesses(ProcessInfo *storingInfo, int maxProcesses, unsigned int *cursor) {
     int processCounter = 0;
-    for (int i = 0; i < MAX_PROCESSES && processCounter < maxProcesses; ++i) {
-        Process *process = &processes[i];
+    unsigned int slot = *cursor;
+    for (; slot < processTableSize && processCounter < maxProcesses; ++slot) {
+        Process *process = &processes[slot];
         if (process->stackEnd != NULL) {
             ProcessInfo *info = &storingInfo[processCounter++];
-            info->pid = i;
+            info->pid = process->pid;
             strncpy(info->name, process->name, MAX_NAME_LENGTH);
             info->stackEnd = process->stackEnd;
             info->stackStart = process->stackStart;
             info->isForeground = process->isForeground;
-            getProcessInfo(i, info);
+            getProcessInfo(process->pid, info);
         }
     }
 
+    *cursor = slot;
     return processCounter;
 }
\ No newline at end of file
@@ -0,0 +1,454 @@
+#ifdef USE_CFS
+
+#include <defs.h>
+#include <lib.h>
+#include <memoryManager.h>
+#include <process.h>
+#include <readyQueue.h>
+#include <time.h>
+
+// Weight of a PRIORITY_DEFAULT process. Each priority step changes the CPU share by about 25%.
+#define NICE_0_WEIGHT  1024
+#define VRUNTIME_SHIFT 10
+
+// Period in which every ready process should run once, and minimum run time before a tick preemption.
+#define CFS_LATENCY_MILLISECONDS         20
+#define CFS_MIN_GRANULARITY_MILLISECONDS 4
+#define CFS_LATENCY_TICKS                MILLISECONDS_TO_TICKS(CFS_LATENCY_MILLISECONDS)
+#define CFS_MIN_GRANULARITY_TICKS        MILLISECONDS_TO_TICKS(CFS_MIN_GRANULARITY_MILLISECONDS)
+
+#define NIL         NO_READY_PROCESS
+#define RED         0
+#define BLACK       1
+#define NODE(pid)   (&nodes[PID_TO_SLOT(pid)])
+#define WEIGHT(pid) (priorityWeights[NODE(pid)->priority - PRIORITY_MAX])
+
+#define TICKS_TO_VRUNTIME(ticks, weight) (((uint64_t) (ticks) * (NICE_0_WEIGHT << VRUNTIME_SHIFT)) / (weight))
+
+typedef struct {
+    Priority priority;
+    uint8_t color;
+    uint64_t vruntime;
+    Pid parent;
+    Pid left;
+    Pid right;
+} ReadyNode;
+
+// Indexed by priority - PRIORITY_MAX, taken from Linux's nice-to-weight table for nice -10..10.
+static const uint32_t priorityWeights[] = {9548, 7620, 6100, 4904, 3906, 3121, 2501, 1991, 1586, 1277, 1024,
+                                           820,  655,  526,  423,  335,  272,  215,  172,  137,  110};
+
+static ReadyNode *nodes = NULL;
+static unsigned int nodesSize = 0;
+
+// Red-black tree of the ready processes ordered by virtual runtime, with its leftmost node cached.
+static Pid root;
+static Pid leftmost;
+static uint64_t readyWeight;
+static uint64_t minVruntime;
+
+static Pid runningPid;
+static unsigned long sliceStartTicks;
+static unsigned long lastUpdateTicks;
+static Pid doneePid;
+static unsigned long donatedSliceStartTicks;
+
+static int
+isRed(Pid pid) {
+    return pid != NIL && NODE(pid)->color == RED;
+}
+
+static void
+replaceChild(Pid parent, Pid oldChild, Pid newChild) {
+    if (parent == NIL)
+        root = newChild;
+    else if (NODE(parent)->left == oldChild)
+        NODE(parent)->left = newChild;
+    else
+        NODE(parent)->right = newChild;
+}
+
+static void
+rotateLeft(Pid x) {
+    ReadyNode *nx = NODE(x);
+    Pid y = nx->right;
+    ReadyNode *ny = NODE(y);
+
+    nx->right = ny->left;
+    if (ny->left != NIL)
+        NODE(ny->left)->parent = x;
+
+    ny->parent = nx->parent;
+    replaceChild(nx->parent, x, y);
+    ny->left = x;
+    nx->parent = y;
+}
+
+static void
+rotateRight(Pid x) {
+    ReadyNode *nx = NODE(x);
+    Pid y = nx->left;
+    ReadyNode *ny = NODE(y);
+
+    nx->left = ny->right;
+    if (ny->right != NIL)
+        NODE(ny->right)->parent = x;
+
+    ny->parent = nx->parent;
+    replaceChild(nx->parent, x, y);
+    ny->right = x;
+    nx->parent = y;
+}
+
+static void
+insertNode(Pid z) {
+    ReadyNode *nz = NODE(z);
+    Pid parent = NIL;
+    Pid x = root;
+    int isLeftmost = 1;
+
+    // Equal keys go to the right, so processes with the same vruntime run in FIFO order.
+    while (x != NIL) {
+        parent = x;
+        if (nz->vruntime < NODE(x)->vruntime)
+            x = NODE(x)->left;
+        else {
+            x = NODE(x)->right;
+            isLeftmost = 0;
+        }
+    }
+
+    nz->parent = parent;
+    nz->left = NIL;
+    nz->right = NIL;
+    nz->color = RED;
+
+    if (parent == NIL)
+        root = z;
+    else if (nz->vruntime < NODE(parent)->vruntime)
+        NODE(parent)->left = z;
+    else
+        NODE(parent)->right = z;
+
+    if (isLeftmost)
+        leftmost = z;
+
+    while (isRed(NODE(z)->parent)) {
+        Pid p = NODE(z)->parent;
+        Pid g = NODE(p)->parent;
+
+        if (p == NODE(g)->left) {
+            Pid uncle = NODE(g)->right;
+            if (isRed(uncle)) {
+                NODE(p)->color = BLACK;
+                NODE(uncle)->color = BLACK;
+                NODE(g)->color = RED;
+                z = g;
+            } else {
+                if (z == NODE(p)->right) {
+                    z = p;
+                    rotateLeft(z);
+                    p = NODE(z)->parent;
+                }
+                NODE(p)->color = BLACK;
+                NODE(g)->color = RED;
+                rotateRight(g);
+            }
+        } else {
+            Pid uncle = NODE(g)->left;
+            if (isRed(uncle)) {
+                NODE(p)->color = BLACK;
+                NODE(uncle)->color = BLACK;
+                NODE(g)->color = RED;
+                z = g;
+            } else {
+                if (z == NODE(p)->left) {
+                    z = p;
+                    rotateRight(z);
+                    p = NODE(z)->parent;
+                }
+                NODE(p)->color = BLACK;
+                NODE(g)->color = RED;
+                rotateLeft(g);
+            }
+        }
+    }
+
+    NODE(root)->color = BLACK;
+}
+
+static Pid
+minimumNode(Pid x) {
+    while (NODE(x)->left != NIL)
+        x = NODE(x)->left;
+    return x;
+}
+
+static void
+eraseFixup(Pid x, Pid parent) {
+    while (x != root && !isRed(x)) {
+        if (x == NODE(parent)->left) {
+            Pid w = NODE(parent)->right;
+            if (isRed(w)) {
+                NODE(w)->color = BLACK;
+                NODE(parent)->color = RED;
+                rotateLeft(parent);
+                w = NODE(parent)->right;
+            }
+
+            if (!isRed(NODE(w)->left) && !isRed(NODE(w)->right)) {
+                NODE(w)->color = RED;
+                x = parent;
+                parent = NODE(x)->parent;
+            } else {
+                if (!isRed(NODE(w)->right)) {
+                    NODE(NODE(w)->left)->color = BLACK;
+                    NODE(w)->color = RED;
+                    rotateRight(w);
+                    w = NODE(parent)->right;
+                }
+                NODE(w)->color = NODE(parent)->color;
+                NODE(parent)->color = BLACK;
+                NODE(NODE(w)->right)->color = BLACK;
+                rotateLeft(parent);
+                x = root;
+            }
+        } else {
+            Pid w = NODE(parent)->left;
+            if (isRed(w)) {
+                NODE(w)->color = BLACK;
+                NODE(parent)->color = RED;
+                rotateRight(parent);
+                w = NODE(parent)->left;
+            }
+
+            if (!isRed(NODE(w)->left) && !isRed(NODE(w)->right)) {
+                NODE(w)->color = RED;
+                x = parent;
+                parent = NODE(x)->parent;
+            } else {
+                if (!isRed(NODE(w)->left)) {
+                    NODE(NODE(w)->right)->color = BLACK;
+                    NODE(w)->color = RED;
+                    rotateLeft(w);
+                    w = NODE(parent)->left;
+                }
+                NODE(w)->color = NODE(parent)->color;
+                NODE(parent)->color = BLACK;
+                NODE(NODE(w)->left)->color = BLACK;
+                rotateRight(parent);
+                x = root;
+            }
+        }
+    }
+
+    if (x != NIL)
+        NODE(x)->color = BLACK;
+}
+
+static void
+eraseNode(Pid z) {
+    ReadyNode *nz = NODE(z);
+
+    if (z == leftmost)
+        leftmost = nz->right != NIL ? minimumNode(nz->right) : nz->parent;
+
+    Pid x, xParent;
+    uint8_t removedColor = nz->color;
+
+    if (nz->left == NIL) {
+        x = nz->right;
+        xParent = nz->parent;
+        replaceChild(nz->parent, z, x);
+        if (x != NIL)
+            NODE(x)->parent = nz->parent;
+    } else if (nz->right == NIL) {
+        x = nz->left;
+        xParent = nz->parent;
+        replaceChild(nz->parent, z, x);
+        NODE(x)->parent = nz->parent;
+    } else {
+        Pid y = minimumNode(nz->right);
+        ReadyNode *ny = NODE(y);
+        removedColor = ny->color;
+        x = ny->right;
+
+        if (ny->parent == z)
+            xParent = y;
+        else {
+            xParent = ny->parent;
+            replaceChild(ny->parent, y, x);
+            if (x != NIL)
+                NODE(x)->parent = ny->parent;
+            ny->right = nz->right;
+            NODE(ny->right)->parent = y;
+        }
+
+        replaceChild(nz->parent, z, y);
+        ny->parent = nz->parent;
+        ny->left = nz->left;
+        NODE(ny->left)->parent = y;
+        ny->color = nz->color;
+    }
+
+    if (removedColor == BLACK)
+        eraseFixup(x, xParent);
+
+    nz->parent = NIL;
+    nz->left = NIL;
+    nz->right = NIL;
+}
+
+static void
+updateMinVruntime() {
+    uint64_t candidate = minVruntime;
+
+    if (runningPid != NIL)
+        candidate = NODE(runningPid)->vruntime;
+
+    if (leftmost != NIL && (runningPid == NIL || NODE(leftmost)->vruntime < candidate))
+        candidate = NODE(leftmost)->vruntime;
+
+    // The minimum only moves forward, so sleepers can not go back in time.
+    if (candidate > minVruntime)
+        minVruntime = candidate;
+}
+
+static void
+updateRunningVruntime() {
+    if (runningPid == NIL)
+        return;
+
+    unsigned long now = getElapsedTicks();
+    NODE(runningPid)->vruntime += TICKS_TO_VRUNTIME(now - lastUpdateTicks, WEIGHT(runningPid));
+    lastUpdateTicks = now;
+    updateMinVruntime();
+}
+
+void
+initializeReadyQueue() {
+    root = NIL;
+    leftmost = NIL;
+    readyWeight = 0;
+    minVruntime = 0;
+    runningPid = NIL;
+    doneePid = NIL;
+}
+
+int
+resizeReadyQueue(unsigned int size) {
+    if (size <= nodesSize)
+        return 0;
+
+    ReadyNode *newNodes = realloc(nodes, size * sizeof(ReadyNode));
+    if (newNodes == NULL)
+        return 1;
+
+    nodes = newNodes;
+    nodesSize = size;
+    return 0;
+}
+
+void
+resetReadyProcess(Pid pid, Priority priority) {
+    ReadyNode *node = NODE(pid);
+    node->priority = priority;
+    node->vruntime = minVruntime;
+    node->parent = NIL;
+    node->left = NIL;
+    node->right = NIL;
+}
+
+void
+setReadyPriority(Pid pid, Priority priority) {
+    if (pid == runningPid)
+        updateRunningVruntime();
+
+    NODE(pid)->priority = priority;
+}
+
+void
+addReadyProcess(Pid pid) {
+    ReadyNode *node = NODE(pid);
+
+    // A process waking up from a long sleep gets at most half a latency period of credit.
+    uint64_t sleeperCredit = TICKS_TO_VRUNTIME(CFS_LATENCY_TICKS, NICE_0_WEIGHT) / 2;
+    if (minVruntime > sleeperCredit && node->vruntime < minVruntime - sleeperCredit)
+        node->vruntime = minVruntime - sleeperCredit;
+
+    insertNode(pid);
+    readyWeight += WEIGHT(pid);
+}
+
+void
+removeReadyProcess(Pid pid) {
+    eraseNode(pid);
+    readyWeight -= WEIGHT(pid);
+}
+
+int
+hasReadyProcess() {
+    return leftmost != NIL;
+}
+
+Pid
+takeNextReadyProcess() {
+    Pid next = leftmost;
+    if (next != NIL)
+        removeReadyProcess(next);
+    return next;
+}
+
+void
+donateSlice(Pid from, Pid to) {
+    donatedSliceStartTicks = sliceStartTicks;
+    doneePid = to;
+}
+
+void
+startSlice(Pid pid) {
+    runningPid = pid;
+    lastUpdateTicks = getElapsedTicks();
+
+    // A donated slice keeps its start, so the receiver only gets what the giver had left.
+    sliceStartTicks = pid == doneePid ? donatedSliceStartTicks : lastUpdateTicks;
+    doneePid = NIL;
+}
+
+int
+shouldPreempt(Pid pid) {
+    // A process that just left the real-time class has no slice yet.
+    if (runningPid == NIL)
+        return 0;
+
+    updateRunningVruntime();
+
+    if (leftmost == NIL)
+        return 0;
+
+    unsigned long ranTicks = getElapsedTicks() - sliceStartTicks;
+    if (ranTicks < CFS_MIN_GRANULARITY_TICKS)
+        return 0;
+
+    // Each process gets a share of the latency period proportional to its weight.
+    uint64_t weight = WEIGHT(pid);
+    uint64_t idealTicks = CFS_LATENCY_TICKS * weight / (readyWeight + weight);
+    if (ranTicks >= idealTicks)
+        return 1;
+
+    return NODE(pid)->vruntime > NODE(leftmost)->vruntime + TICKS_TO_VRUNTIME(CFS_MIN_GRANULARITY_TICKS, NICE_0_WEIGHT);
+}
+
+void
+blockSlice(Pid pid) {}
+
+void
+endSlice(Pid pid) {
+    if (pid != runningPid)
+        return;
+
+    updateRunningVruntime();
+    runningPid = NIL;
+}
+
+#endif
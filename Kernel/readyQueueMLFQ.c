@@ -0,0 +1,276 @@
+#ifdef USE_MLFQ
+
+#include <defs.h>
+#include <lib.h>
+#include <memoryManager.h>
+#include <process.h>
+#include <readyQueue.h>
+#include <time.h>
+
+/*
+ * Multi-level feedback queue. There is one FIFO per priority level, as in round robin, but a process does not stay
+ * at the level of its priority: it is demoted one level each time it uses up the allotment of its level, and
+ * promoted one level when it blocks having used little of its slice. The priority set by the user is the base level
+ * the process starts at and is brought back to by the periodic boost, so CPU-bound processes can not starve.
+ */
+#define PRIORITY_LEVELS      (PRIORITY_MIN - PRIORITY_MAX + 1)
+#define PRIORITY_TO_LEVEL(p) ((p) - PRIORITY_MAX)
+#define LEVEL_BIT(level)     ((uint32_t) 1 << (level))
+#define NODE(pid)            (&nodes[PID_TO_SLOT(pid)])
+
+// How far from its base level a process may move
+#define MLFQ_MAX_PROMOTION 3
+#define MLFQ_MAX_DEMOTION  4
+
+// Allotment at the base level and above, doubled for every level a process is demoted
+#define MLFQ_QUANTUM_MILLISECONDS 10
+#define QUANTUM_TICKS(node)       MILLISECONDS_TO_TICKS(MLFQ_QUANTUM_MILLISECONDS << ((node)->offset > 0 ? (node)->offset : 0))
+
+// Every process is brought back to its base level this often
+#define MLFQ_BOOST_MILLISECONDS 1000
+
+typedef struct {
+    Priority priority;        // Base level, set by the user
+    int offset;               // Levels below (positive) or above (negative) the base level
+    int level;                // Level the process is queued at
+    unsigned long usedTicks;  // Allotment used at the current level
+    unsigned int boostEpoch;
+    Pid previous;
+    Pid next;
+} ReadyNode;
+
+typedef struct {
+    Pid first;
+    Pid last;
+} Level;
+
+static ReadyNode *nodes = NULL;
+static unsigned int nodesSize = 0;
+static Level levels[PRIORITY_LEVELS];
+static uint32_t readyLevelsBitmap;
+
+static Pid runningPid;
+static unsigned long sliceTicks;
+static unsigned long sliceLimit;
+static Pid doneePid;
+static unsigned long donatedTicks;
+
+static unsigned int boostEpoch;
+static unsigned long lastBoostTicks;
+
+static int
+getLevel(ReadyNode *node) {
+    int priority = node->priority + node->offset;
+    if (priority < PRIORITY_MAX)
+        priority = PRIORITY_MAX;
+    else if (priority > PRIORITY_MIN)
+        priority = PRIORITY_MIN;
+    return PRIORITY_TO_LEVEL(priority);
+}
+
+static void
+moveLevels(ReadyNode *node, int levelsDown) {
+    node->offset += levelsDown;
+    if (node->offset < -MLFQ_MAX_PROMOTION)
+        node->offset = -MLFQ_MAX_PROMOTION;
+    else if (node->offset > MLFQ_MAX_DEMOTION)
+        node->offset = MLFQ_MAX_DEMOTION;
+    node->usedTicks = 0;
+}
+
+// Processes that were not queued during a boost catch up with it lazily.
+static void
+catchUpBoost(ReadyNode *node) {
+    if (node->boostEpoch == boostEpoch)
+        return;
+
+    node->boostEpoch = boostEpoch;
+    node->offset = 0;
+    node->usedTicks = 0;
+}
+
+static void
+boostIfDue() {
+    unsigned long now = getElapsedTicks();
+    if (now - lastBoostTicks < MILLISECONDS_TO_TICKS(MLFQ_BOOST_MILLISECONDS))
+        return;
+
+    lastBoostTicks = now;
+    boostEpoch++;
+
+    // Queued processes are requeued at their base level right away, in their current order.
+    for (int level = 0; level < PRIORITY_LEVELS; level++) {
+        Pid pid = levels[level].first;
+        levels[level].first = NO_READY_PROCESS;
+        levels[level].last = NO_READY_PROCESS;
+        readyLevelsBitmap &= ~LEVEL_BIT(level);
+
+        while (pid != NO_READY_PROCESS) {
+            Pid next = NODE(pid)->next;
+            addReadyProcess(pid);
+            pid = next;
+        }
+    }
+}
+
+void
+initializeReadyQueue() {
+    for (int i = 0; i < PRIORITY_LEVELS; i++) {
+        levels[i].first = NO_READY_PROCESS;
+        levels[i].last = NO_READY_PROCESS;
+    }
+
+    readyLevelsBitmap = 0;
+    runningPid = NO_READY_PROCESS;
+    doneePid = NO_READY_PROCESS;
+    boostEpoch = 0;
+    lastBoostTicks = 0;
+}
+
+int
+resizeReadyQueue(unsigned int size) {
+    if (size <= nodesSize)
+        return 0;
+
+    ReadyNode *newNodes = realloc(nodes, size * sizeof(ReadyNode));
+    if (newNodes == NULL)
+        return 1;
+
+    nodes = newNodes;
+    nodesSize = size;
+    return 0;
+}
+
+void
+resetReadyProcess(Pid pid, Priority priority) {
+    ReadyNode *node = NODE(pid);
+    node->priority = priority;
+    node->offset = 0;
+    node->usedTicks = 0;
+    node->boostEpoch = boostEpoch;
+    node->previous = NO_READY_PROCESS;
+    node->next = NO_READY_PROCESS;
+}
+
+void
+setReadyPriority(Pid pid, Priority priority) {
+    NODE(pid)->priority = priority;
+}
+
+void
+addReadyProcess(Pid pid) {
+    ReadyNode *node = NODE(pid);
+    catchUpBoost(node);
+
+    node->level = getLevel(node);
+    Level *queue = &levels[node->level];
+
+    node->previous = queue->last;
+    node->next = NO_READY_PROCESS;
+
+    if (queue->last == NO_READY_PROCESS)
+        queue->first = pid;
+    else
+        NODE(queue->last)->next = pid;
+
+    queue->last = pid;
+    readyLevelsBitmap |= LEVEL_BIT(node->level);
+}
+
+void
+removeReadyProcess(Pid pid) {
+    ReadyNode *node = NODE(pid);
+    Level *queue = &levels[node->level];
+
+    if (node->previous == NO_READY_PROCESS)
+        queue->first = node->next;
+    else
+        NODE(node->previous)->next = node->next;
+
+    if (node->next == NO_READY_PROCESS)
+        queue->last = node->previous;
+    else
+        NODE(node->next)->previous = node->previous;
+
+    node->previous = NO_READY_PROCESS;
+    node->next = NO_READY_PROCESS;
+
+    if (queue->first == NO_READY_PROCESS)
+        readyLevelsBitmap &= ~LEVEL_BIT(node->level);
+}
+
+int
+hasReadyProcess() {
+    return readyLevelsBitmap != 0;
+}
+
+Pid
+takeNextReadyProcess() {
+    boostIfDue();
+
+    if (readyLevelsBitmap == 0)
+        return NO_READY_PROCESS;
+
+    Pid next = levels[__builtin_ctz(readyLevelsBitmap)].first;
+    removeReadyProcess(next);
+    return next;
+}
+
+void
+donateSlice(Pid from, Pid to) {
+    donatedTicks = sliceLimit > sliceTicks ? sliceLimit - sliceTicks : 1;
+    doneePid = to;
+}
+
+void
+startSlice(Pid pid) {
+    ReadyNode *node = NODE(pid);
+    catchUpBoost(node);
+
+    runningPid = pid;
+    node->level = getLevel(node);
+    sliceTicks = 0;
+
+    if (pid == doneePid) {
+        sliceLimit = donatedTicks;
+        doneePid = NO_READY_PROCESS;
+    } else {
+        // A process preempted by a higher level keeps what is left of its allotment.
+        unsigned long quantum = QUANTUM_TICKS(node);
+        sliceLimit = node->usedTicks < quantum ? quantum - node->usedTicks : 1;
+    }
+}
+
+int
+shouldPreempt(Pid pid) {
+    ReadyNode *node = NODE(pid);
+    boostIfDue();
+    catchUpBoost(node);
+
+    sliceTicks++;
+    node->usedTicks++;
+
+    // CPU hogs sink one level for every allotment they use up.
+    if (node->usedTicks >= QUANTUM_TICKS(node)) {
+        moveLevels(node, 1);
+        return 1;
+    }
+
+    uint32_t higherLevels = LEVEL_BIT(getLevel(node)) - 1;
+    return sliceTicks >= sliceLimit || (readyLevelsBitmap & higherLevels) != 0;
+}
+
+void
+blockSlice(Pid pid) {
+    // Processes that block early, like keyboard readers and pipe consumers, rise one level.
+    if (pid == runningPid && sliceTicks * 2 < QUANTUM_TICKS(NODE(pid)))
+        moveLevels(NODE(pid), -1);
+}
+
+void
+endSlice(Pid pid) {
+    if (pid == runningPid)
+        runningPid = NO_READY_PROCESS;
+}
+
+#endif
@@ -0,0 +1,218 @@
+#if !defined(USE_CFS) && !defined(USE_MLFQ)
+
+#include <defs.h>
+#include <lib.h>
+#include <memoryManager.h>
+#include <process.h>
+#include <readyQueue.h>
+#include <time.h>
+
+/*
+ * One FIFO per priority level, level 0 being PRIORITY_MAX, in each of two arrays. Processes run from the active array
+ * highest level first, and move to the expired array once they spend their quantum. When the active array runs out
+ * the arrays are swapped, so every READY process gets its quantum each round however busy the higher levels are.
+ */
+#define PRIORITY_LEVELS      (PRIORITY_MIN - PRIORITY_MAX + 1)
+#define PRIORITY_TO_LEVEL(p) ((p) - PRIORITY_MAX)
+#define LEVEL_BIT(level)     ((uint32_t) 1 << (level))
+#define NODE(pid)            (&nodes[PID_TO_SLOT(pid)])
+
+// Time slice of a process, from QUANTUM_MILLISECONDS at PRIORITY_MIN growing by QUANTUM_STEP_MILLISECONDS per level
+#define QUANTUM_MILLISECONDS      10
+#define QUANTUM_STEP_MILLISECONDS 5
+#define QUANTUM_TICKS(p)          MILLISECONDS_TO_TICKS(QUANTUM_MILLISECONDS + (PRIORITY_MIN - (p)) * QUANTUM_STEP_MILLISECONDS)
+
+typedef struct {
+    Priority priority;
+    unsigned int quantumLeft;  // Ticks of its quantum the process has not used yet this round
+    unsigned int array;
+    Pid previous;
+    Pid next;
+} ReadyNode;
+
+typedef struct {
+    Pid first;
+    Pid last;
+} Level;
+
+typedef struct {
+    Level levels[PRIORITY_LEVELS];
+    uint32_t readyLevelsBitmap;
+} PriorityArray;
+
+static ReadyNode *nodes = NULL;
+static unsigned int nodesSize = 0;
+static PriorityArray arrays[2];
+static unsigned int activeArray;
+static Pid runningPid;
+static unsigned int currentQuantum;
+static int sliceDonated;
+static Pid doneePid;
+static unsigned int donatedQuantum;
+
+void
+initializeReadyQueue() {
+    for (int a = 0; a < 2; a++) {
+        for (int i = 0; i < PRIORITY_LEVELS; i++) {
+            arrays[a].levels[i].first = NO_READY_PROCESS;
+            arrays[a].levels[i].last = NO_READY_PROCESS;
+        }
+        arrays[a].readyLevelsBitmap = 0;
+    }
+
+    activeArray = 0;
+    runningPid = NO_READY_PROCESS;
+    currentQuantum = 0;
+    sliceDonated = 0;
+    doneePid = NO_READY_PROCESS;
+}
+
+int
+resizeReadyQueue(unsigned int size) {
+    if (size <= nodesSize)
+        return 0;
+
+    ReadyNode *newNodes = realloc(nodes, size * sizeof(ReadyNode));
+    if (newNodes == NULL)
+        return 1;
+
+    nodes = newNodes;
+    nodesSize = size;
+    return 0;
+}
+
+void
+resetReadyProcess(Pid pid, Priority priority) {
+    ReadyNode *node = NODE(pid);
+    node->priority = priority;
+    node->quantumLeft = QUANTUM_TICKS(priority);
+    node->previous = NO_READY_PROCESS;
+    node->next = NO_READY_PROCESS;
+}
+
+void
+setReadyPriority(Pid pid, Priority priority) {
+    ReadyNode *node = NODE(pid);
+    node->priority = priority;
+    if (node->quantumLeft > QUANTUM_TICKS(priority))
+        node->quantumLeft = QUANTUM_TICKS(priority);
+}
+
+void
+addReadyProcess(Pid pid) {
+    ReadyNode *node = NODE(pid);
+
+    // A process that spent its quantum waits for the next round with a new one.
+    node->array = activeArray;
+    if (node->quantumLeft == 0) {
+        node->quantumLeft = QUANTUM_TICKS(node->priority);
+        node->array ^= 1;
+    }
+
+    PriorityArray *array = &arrays[node->array];
+    int level = PRIORITY_TO_LEVEL(node->priority);
+    Level *queue = &array->levels[level];
+
+    node->previous = queue->last;
+    node->next = NO_READY_PROCESS;
+
+    if (queue->last == NO_READY_PROCESS)
+        queue->first = pid;
+    else
+        NODE(queue->last)->next = pid;
+
+    queue->last = pid;
+    array->readyLevelsBitmap |= LEVEL_BIT(level);
+}
+
+void
+removeReadyProcess(Pid pid) {
+    ReadyNode *node = NODE(pid);
+    PriorityArray *array = &arrays[node->array];
+    int level = PRIORITY_TO_LEVEL(node->priority);
+    Level *queue = &array->levels[level];
+
+    if (node->previous == NO_READY_PROCESS)
+        queue->first = node->next;
+    else
+        NODE(node->previous)->next = node->next;
+
+    if (node->next == NO_READY_PROCESS)
+        queue->last = node->previous;
+    else
+        NODE(node->next)->previous = node->previous;
+
+    node->previous = NO_READY_PROCESS;
+    node->next = NO_READY_PROCESS;
+
+    if (queue->first == NO_READY_PROCESS)
+        array->readyLevelsBitmap &= ~LEVEL_BIT(level);
+}
+
+int
+hasReadyProcess() {
+    return (arrays[0].readyLevelsBitmap | arrays[1].readyLevelsBitmap) != 0;
+}
+
+Pid
+takeNextReadyProcess() {
+    if (arrays[activeArray].readyLevelsBitmap == 0)
+        activeArray ^= 1;
+
+    PriorityArray *array = &arrays[activeArray];
+    if (array->readyLevelsBitmap == 0)
+        return NO_READY_PROCESS;
+
+    Pid next = array->levels[__builtin_ctz(array->readyLevelsBitmap)].first;
+    removeReadyProcess(next);
+    return next;
+}
+
+void
+donateSlice(Pid from, Pid to) {
+    donatedQuantum = currentQuantum;
+    currentQuantum = 0;
+    doneePid = to;
+}
+
+void
+startSlice(Pid pid) {
+    runningPid = pid;
+
+    // A donated slice is charged to the giver, so the receiver keeps what is left of its own quantum.
+    sliceDonated = pid == doneePid;
+    if (sliceDonated) {
+        currentQuantum = donatedQuantum;
+        doneePid = NO_READY_PROCESS;
+        return;
+    }
+
+    currentQuantum = NODE(pid)->quantumLeft;
+}
+
+int
+shouldPreempt(Pid pid) {
+    // Called once per tick, so the tick that runs out the quantum preempts.
+    if (currentQuantum != 0)
+        currentQuantum--;
+
+    uint32_t higherLevels = LEVEL_BIT(PRIORITY_TO_LEVEL(NODE(pid)->priority)) - 1;
+    return currentQuantum == 0 || (arrays[activeArray].readyLevelsBitmap & higherLevels) != 0;
+}
+
+void
+blockSlice(Pid pid) {}
+
+void
+endSlice(Pid pid) {
+    if (pid != runningPid)
+        return;
+
+    if (!sliceDonated)
+        NODE(pid)->quantumLeft = currentQuantum;
+    runningPid = NO_READY_PROCESS;
+    currentQuantum = 0;
+    sliceDonated = 0;
+}
+
+#endif
@@ -0,0 +1,179 @@
+#include <defs.h>
+#include <lib.h>
+#include <memoryManager.h>
+#include <process.h>
+#include <readyQueue.h>
+#include <realTime.h>
+
+#define NODE(pid) (&nodes[PID_TO_SLOT(pid)])
+
+/*
+ * Admission bounds the density, runtime over deadline, which is at least the utilization and keeps EDF meeting every
+ * deadline even when they are shorter than the period. It is kept in fixed point, and part of the CPU is left for the
+ * ready queue so normal processes never starve.
+ */
+#define DENSITY_SCALE              1000000UL
+#define MAX_DENSITY                (DENSITY_SCALE * 95 / 100)
+#define DENSITY(runtime, deadline) ((runtime) * DENSITY_SCALE / (deadline))
+#define NOT_REAL_TIME              0
+
+typedef struct {
+    unsigned long period;  // NOT_REAL_TIME for processes in the ready queue
+    unsigned long runtime;
+    unsigned long deadline;
+
+    // Current job
+    unsigned long absoluteDeadline;
+    unsigned long nextRelease;
+    unsigned long budget;
+    unsigned long chargedUntil;
+
+    Pid previous;
+    Pid next;
+} RealTimeNode;
+
+static RealTimeNode *nodes = NULL;
+static unsigned int nodesSize = 0;
+static Pid queue;
+static unsigned long totalDensity;
+
+static void
+releaseJob(RealTimeNode *node, unsigned long now) {
+    if (now < node->nextRelease)
+        return;
+
+    // Jobs missed while blocked or throttled are skipped, keeping releases in phase with the period.
+    unsigned long release = node->nextRelease + (now - node->nextRelease) / node->period * node->period;
+    node->absoluteDeadline = release + node->deadline;
+    node->nextRelease = release + node->period;
+    node->budget = node->runtime;
+}
+
+void
+initializeRealTime() {
+    queue = NO_READY_PROCESS;
+    totalDensity = 0;
+}
+
+int
+resizeRealTime(unsigned int size) {
+    if (size <= nodesSize)
+        return 0;
+
+    RealTimeNode *newNodes = realloc(nodes, size * sizeof(RealTimeNode));
+    if (newNodes == NULL)
+        return 1;
+
+    for (unsigned int i = nodesSize; i < size; i++)
+        newNodes[i].period = NOT_REAL_TIME;
+
+    nodes = newNodes;
+    nodesSize = size;
+    return 0;
+}
+
+int
+setRealTimeParameters(Pid pid, unsigned long period, unsigned long runtime, unsigned long deadline, unsigned long now) {
+    if (pid < 0 || PID_TO_SLOT(pid) >= nodesSize)
+        return 1;
+
+    RealTimeNode *node = NODE(pid);
+    if (period != NOT_REAL_TIME && (runtime == 0 || runtime > deadline || deadline > period))
+        return 1;
+
+    unsigned long density = period == NOT_REAL_TIME ? 0 : DENSITY(runtime, deadline);
+    unsigned long otherDensity = totalDensity - (node->period == NOT_REAL_TIME ? 0 : DENSITY(node->runtime, node->deadline));
+    if (otherDensity + density > MAX_DENSITY)
+        return 1;
+
+    totalDensity = otherDensity + density;
+    node->period = period;
+    node->runtime = runtime;
+    node->deadline = deadline;
+    node->nextRelease = now;
+    node->chargedUntil = now;
+    node->previous = NO_READY_PROCESS;
+    node->next = NO_READY_PROCESS;
+
+    if (period != NOT_REAL_TIME)
+        releaseJob(node, now);
+    return 0;
+}
+
+int
+isRealTimeProcess(Pid pid) {
+    return pid >= 0 && PID_TO_SLOT(pid) < nodesSize && NODE(pid)->period != NOT_REAL_TIME;
+}
+
+void
+addRealTimeProcess(Pid pid) {
+    RealTimeNode *node = NODE(pid);
+    node->previous = NO_READY_PROCESS;
+    node->next = queue;
+    if (queue != NO_READY_PROCESS)
+        NODE(queue)->previous = pid;
+    queue = pid;
+}
+
+void
+removeRealTimeProcess(Pid pid) {
+    RealTimeNode *node = NODE(pid);
+
+    if (node->previous == NO_READY_PROCESS)
+        queue = node->next;
+    else
+        NODE(node->previous)->next = node->next;
+
+    if (node->next != NO_READY_PROCESS)
+        NODE(node->next)->previous = node->previous;
+
+    node->previous = NO_READY_PROCESS;
+    node->next = NO_READY_PROCESS;
+}
+
+Pid
+peekRealTimeProcess(unsigned long now) {
+    // The class is bounded by its density, so a linear scan over the few queued processes is enough.
+    Pid earliest = NO_READY_PROCESS;
+    for (Pid pid = queue; pid != NO_READY_PROCESS; pid = NODE(pid)->next) {
+        releaseJob(NODE(pid), now);
+        if (NODE(pid)->budget != 0 && (earliest == NO_READY_PROCESS || hasEarlierDeadline(earliest, pid)))
+            earliest = pid;
+    }
+
+    return earliest;
+}
+
+int
+chargeRealTimeProcess(Pid pid, unsigned long now) {
+    RealTimeNode *node = NODE(pid);
+    unsigned long consumed = now - node->chargedUntil;
+    node->chargedUntil = now;
+    node->budget = consumed >= node->budget ? 0 : node->budget - consumed;
+
+    releaseJob(node, now);
+    return node->budget != 0;
+}
+
+void
+startRealTimeProcess(Pid pid, unsigned long now) {
+    NODE(pid)->chargedUntil = now;
+}
+
+int
+hasEarlierDeadline(Pid pid, Pid other) {
+    return NODE(other)->absoluteDeadline < NODE(pid)->absoluteDeadline;
+}
+
+unsigned long
+getTicksToNextRelease(unsigned long now) {
+    unsigned long ticks = 0;
+    for (Pid pid = queue; pid != NO_READY_PROCESS; pid = NODE(pid)->next) {
+        RealTimeNode *node = NODE(pid);
+        unsigned long delta = node->nextRelease > now ? node->nextRelease - now : 1;
+        if (node->budget == 0 && (ticks == 0 || delta < ticks))
+            ticks = delta;
+    }
+
+    return ticks;
+}
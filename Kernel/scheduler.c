@@ -1,63 +1,241 @@
 #include <defs.h>
+#include <fpu.h>
 #include <interrupts.h>
+#include <lib.h>
 #include <memoryManager.h>
 #include <process.h>
+#include <readyQueue.h>
+#include <realTime.h>
 #include <scheduler.h>
-
-#define QUANTUM 5
+#include <time.h>
+#include <timerWheel.h>
+#include <trace.h>
 
 // Pseudo PIDs for limit cases
 #define PSEUDOPID_KERNEL -1
 #define PSEUDOPID_NONE   -2
 
+#define PROCESS_TABLE_MIN_SIZE 16
+#define PCB(pid)               (&processTable[PID_TO_SLOT(pid)])
+
+// Important processes woken up and waiting to preempt whatever is running, most important first
+#define WAKE_QUEUE_SIZE 16
+
 typedef struct {
-    Priority priority;
+    Pid pid;
+    Priority priority;      // Effective priority, may be raised by priority inheritance
+    Priority basePriority;  // Priority set at creation or by setPriority()
     ProcessStatus status;
     void *currentRSP;
+
+    // Accounting, in ticks
+    unsigned long createdTicks;
+    unsigned long runTicks;
+    unsigned long waitTicks;
+    unsigned long lastRunTicks;
+    unsigned long readySinceTicks;
+    unsigned long voluntarySwitches;
+    unsigned long involuntarySwitches;
 } ProcessControlBlock;
 
 static void *mainRSP;
 
-static ProcessControlBlock processTable[MAX_PROCESSES];
+static ProcessControlBlock *processTable = NULL;
+static unsigned int processTableSize = 0;
 static Pid currentRunningPID;
-static Pid forceRunNextPID;
-static uint8_t currentQuantum;
+static int sliceExpired;
+static Pid handOffPid;
+
+static Pid wakeQueue[WAKE_QUEUE_SIZE];
+static unsigned int wakeQueueLength;
+static int reschedulePending;
 
 extern void *createProcessStack(int argc, const char *const argv[], void *rsp, ProcessStart start);
 
 static int
 isValidPid(Pid pid) {
-    return pid >= 0 && pid < MAX_PROCESSES;
+    return pid >= 0 && PID_TO_SLOT(pid) < processTableSize && PCB(pid)->pid == pid;
 }
 
 static int
 isActiveProcess(Pid pid) {
-    return isValidPid(pid) && processTable[pid].currentRSP != NULL;
+    return isValidPid(pid) && PCB(pid)->currentRSP != NULL;
 }
 
 static int
 isReadyProcess(Pid pid) {
-    return isActiveProcess(pid) && processTable[pid].status == READY;
+    return isActiveProcess(pid) && PCB(pid)->status == READY;
 }
 
 static int
-getCurrentQuantum(Pid pid) {
-    return PRIORITY_MIN - processTable[pid].priority;
+isRunningProcess(Pid pid) {
+    return isActiveProcess(pid) && PCB(pid)->status == RUNNING;
+}
+
+// READY real-time processes are queued by their class, every other READY process by the ready queue.
+static void
+enqueueProcess(Pid pid) {
+    if (isRealTimeProcess(pid))
+        addRealTimeProcess(pid);
+    else
+        addReadyProcess(pid);
+}
+
+static void
+dequeueProcess(Pid pid) {
+    if (isRealTimeProcess(pid))
+        removeRealTimeProcess(pid);
+    else
+        removeReadyProcess(pid);
 }
 
 static Pid
-getNextReadyPid() {
-    Pid first = currentRunningPID < 0 ? 0 : currentRunningPID;
-    Pid next = first;
-
-    do {
-        next = (next + 1) % MAX_PROCESSES;
-        if (isReadyProcess(next)) {
-            return next;
+takeNextProcess(unsigned long now) {
+    Pid pid = peekRealTimeProcess(now);
+    if (pid == NO_READY_PROCESS)
+        return takeNextReadyProcess();
+
+    removeRealTimeProcess(pid);
+    return pid;
+}
+
+static void
+stopCurrentProcess(unsigned long now) {
+    if (!isValidPid(currentRunningPID))
+        return;
+
+    ProcessControlBlock *pcb = PCB(currentRunningPID);
+    endSlice(currentRunningPID);
+    if (isRealTimeProcess(currentRunningPID))
+        chargeRealTimeProcess(currentRunningPID, now);
+    pcb->runTicks += now - pcb->lastRunTicks;
+    pcb->lastRunTicks = now;
+
+    if (isRunningProcess(currentRunningPID)) {
+        pcb->status = READY;
+        pcb->readySinceTicks = now;
+        enqueueProcess(currentRunningPID);
+    }
+}
+
+static void
+removeWake(unsigned int index) {
+    wakeQueueLength--;
+    for (unsigned int i = index; i < wakeQueueLength; i++)
+        wakeQueue[i] = wakeQueue[i + 1];
+}
+
+static void
+pushWake(Pid pid, Priority priority) {
+    unsigned int i = wakeQueueLength;
+
+    // When full, the least important entry makes room. It stays in the ready queue, it just loses its head start.
+    if (i == WAKE_QUEUE_SIZE) {
+        if (PCB(wakeQueue[i - 1])->priority <= priority)
+            return;
+        i--;
+    } else {
+        wakeQueueLength++;
+    }
+
+    // FIFO among equal priorities.
+    for (; i > 0 && PCB(wakeQueue[i - 1])->priority > priority; i--)
+        wakeQueue[i] = wakeQueue[i - 1];
+    wakeQueue[i] = pid;
+}
+
+static Pid
+peekWake() {
+    // Entries of processes that were scheduled normally, blocked again, died or became real-time since waking up are
+    // dropped.
+    while (wakeQueueLength != 0 && (!isReadyProcess(wakeQueue[0]) || isRealTimeProcess(wakeQueue[0])))
+        removeWake(0);
+
+    return wakeQueueLength == 0 ? PSEUDOPID_NONE : wakeQueue[0];
+}
+
+static int
+shouldWakePreempt(Pid pid) {
+    if (!isRunningProcess(currentRunningPID))
+        return 1;
+
+    return !isRealTimeProcess(currentRunningPID) && PCB(pid)->priority <= PCB(currentRunningPID)->priority;
+}
+
+static int
+shouldPreemptCurrent(Pid realTimePid, unsigned long now) {
+    // Real-time processes run until their budget is spent or a job with an earlier deadline is eligible.
+    if (isRealTimeProcess(currentRunningPID))
+        return !chargeRealTimeProcess(currentRunningPID, now) ||
+               (realTimePid != NO_READY_PROCESS && hasEarlierDeadline(currentRunningPID, realTimePid));
+
+    return realTimePid != NO_READY_PROCESS || shouldPreempt(currentRunningPID);
+}
+
+static void
+startProcess(Pid pid, unsigned long now) {
+    ProcessControlBlock *pcb = PCB(pid);
+    for (unsigned int i = 0; i < wakeQueueLength; i++) {
+        if (wakeQueue[i] == pid) {
+            removeWake(i);
+            break;
         }
-    } while (next != first);
+    }
+
+    pcb->waitTicks += now - pcb->readySinceTicks;
+    pcb->lastRunTicks = now;
+    if (isRealTimeProcess(pid))
+        startRealTimeProcess(pid, now);
+    else
+        startSlice(pid);
+    onFpuSwitch(pid);
+}
+
+static void
+countSwitch(Pid previousPid, int preempted) {
+    if (previousPid == currentRunningPID)
+        return;
+
+    traceEvent(TRACE_SWITCH_OUT, previousPid, preempted);
+    traceEvent(TRACE_SWITCH_IN, currentRunningPID, previousPid);
+
+    if (!isValidPid(previousPid))
+        return;
+
+    if (preempted)
+        PCB(previousPid)->involuntarySwitches++;
+    else
+        PCB(previousPid)->voluntarySwitches++;
+}
+
+static int
+ensureProcessTableSize(unsigned int requiredSize) {
+    if (requiredSize <= processTableSize)
+        return 0;
+
+    // Grow geometrically so that creating many processes costs amortized O(1) copies.
+    unsigned int newSize = processTableSize == 0 ? PROCESS_TABLE_MIN_SIZE : processTableSize;
+    while (newSize < requiredSize)
+        newSize *= 2;
+
+    ProcessControlBlock *newTable = realloc(processTable, newSize * sizeof(ProcessControlBlock));
+    if (newTable == NULL)
+        return 1;
+
+    // The table may have moved already, so keep the new pointer even if the ready queue can not grow.
+    if (resizeReadyQueue(newSize) != 0 || resizeRealTime(newSize) != 0 || resizeTimerWheel(newSize) != 0 ||
+        resizeFpuStates(newSize) != 0) {
+        processTable = newTable;
+        return 1;
+    }
+
+    memset(&newTable[processTableSize], 0, (newSize - processTableSize) * sizeof(ProcessControlBlock));
+    for (unsigned int i = processTableSize; i < newSize; i++)
+        newTable[i].pid = PSEUDOPID_NONE;
 
-    return PSEUDOPID_KERNEL;
+    processTable = newTable;
+    processTableSize = newSize;
+    return 0;
 }
 
 static int
@@ -65,15 +243,21 @@ getProcessState(Pid pid, ProcessControlBlock **pcb) {
     if (!isActiveProcess(pid))
         return 0;
 
-    *pcb = &processTable[pid];
+    *pcb = PCB(pid);
     return 1;
 }
 
 void
 initializeScheduler() {
-    forceRunNextPID = PSEUDOPID_NONE;
+    wakeQueueLength = 0;
+    reschedulePending = 0;
     currentRunningPID = PSEUDOPID_KERNEL;
-    currentQuantum = 0;
+    sliceExpired = 0;
+    handOffPid = PSEUDOPID_NONE;
+    initializeReadyQueue();
+    initializeRealTime();
+    initializeTimerWheel();
+    initializeFpu();
 }
 
 int
@@ -81,9 +265,24 @@ onProcessCreated(Pid pid, ProcessStart start, Priority priority, void *currentRS
     if (priority < PRIORITY_MAX || priority > PRIORITY_MIN)
         priority = PRIORITY_DEFAULT;
 
-    processTable[pid].priority = priority;
-    processTable[pid].status = READY;
-    processTable[pid].currentRSP = createProcessStack(argc, argv, currentRSP, start);
+    if (pid < 0 || ensureProcessTableSize(PID_TO_SLOT(pid) + 1) != 0 || resetFpuState(pid) != 0)
+        return 1;
+
+    PCB(pid)->pid = pid;
+    PCB(pid)->priority = priority;
+    PCB(pid)->basePriority = priority;
+    PCB(pid)->status = READY;
+    PCB(pid)->currentRSP = createProcessStack(argc, argv, currentRSP, start);
+    PCB(pid)->createdTicks = getElapsedTicks();
+    PCB(pid)->runTicks = 0;
+    PCB(pid)->waitTicks = 0;
+    PCB(pid)->lastRunTicks = PCB(pid)->createdTicks;
+    PCB(pid)->readySinceTicks = PCB(pid)->createdTicks;
+    PCB(pid)->voluntarySwitches = 0;
+    PCB(pid)->involuntarySwitches = 0;
+    resetReadyProcess(pid, priority);
+    addReadyProcess(pid);
+    traceEvent(TRACE_CREATE, pid, currentRunningPID);
     return 0;
 }
 
@@ -96,11 +295,20 @@ onProcessKilled(Pid pid) {
     if (pcb->status == KILLED)
         return 0;
 
+    if (pcb->status == READY)
+        dequeueProcess(pid);
+
+    cancelSleeper(pid);
+    setRealTimeParameters(pid, 0, 0, 0, getElapsedTicks());
+    releaseFpuState(pid);
+    traceEvent(TRACE_KILL, pid, currentRunningPID);
     pcb->status = KILLED;
     pcb->currentRSP = NULL;
 
-    if (currentRunningPID == pid)
+    if (currentRunningPID == pid) {
+        endSlice(pid);
         currentRunningPID = PSEUDOPID_NONE;
+    }
 
     return 0;
 }
@@ -111,10 +319,16 @@ block(Pid pid) {
     if (!getProcessState(pid, &pcb))
         return 1;
 
+    if (pcb->status == READY)
+        dequeueProcess(pid);
+    else if (pcb->status == RUNNING)
+        blockSlice(pid);
+
     pcb->status = BLOCKED;
+    traceEvent(TRACE_BLOCK, pid, currentRunningPID);
 
     if (currentRunningPID == pid)
-        currentQuantum = 0;
+        sliceExpired = 1;
 
     return 0;
 }
@@ -128,10 +342,22 @@ unblock(Pid pid) {
     if (pcb->status == READY || pcb->status == RUNNING)
         return 0;
 
-    if (pcb->priority <= PRIORITY_IMPORTANT)
-        forceRunNextPID = pid;
+    // Whatever woke the process up, it is not sleeping anymore.
+    cancelSleeper(pid);
 
     pcb->status = READY;
+    pcb->readySinceTicks = getElapsedTicks();
+    enqueueProcess(pid);
+    traceEvent(TRACE_UNBLOCK, pid, currentRunningPID);
+
+    // Real-time processes are not ordered by priority, let switchProcess() compare deadlines right away.
+    if (isRealTimeProcess(pid)) {
+        reschedulePending = 1;
+    } else if (pcb->priority <= PRIORITY_IMPORTANT) {
+        pushWake(pid, pcb->priority);
+        if (shouldWakePreempt(pid))
+            reschedulePending = 1;
+    }
 
     return 0;
 }
@@ -141,6 +367,21 @@ getpid() {
     return currentRunningPID;
 }
 
+static void
+applyPriority(Pid pid, ProcessControlBlock *pcb, Priority priority) {
+    if (pcb->priority == priority)
+        return;
+
+    if (pcb->status == READY) {
+        dequeueProcess(pid);
+        setReadyPriority(pid, priority);
+        enqueueProcess(pid);
+    } else
+        setReadyPriority(pid, priority);
+
+    pcb->priority = priority;
+}
+
 int
 setPriority(Pid pid, Priority newPriority) {
     ProcessControlBlock *pcb;
@@ -150,45 +391,175 @@ setPriority(Pid pid, Priority newPriority) {
     if (newPriority < PRIORITY_MAX || newPriority > PRIORITY_MIN)
         return 1;
 
-    pcb->priority = newPriority;
+    // An inherited priority is kept until restorePriority(), unless the new one is higher.
+    if (pcb->priority == pcb->basePriority || newPriority < pcb->priority)
+        applyPriority(pid, pcb, newPriority);
+
+    pcb->basePriority = newPriority;
+
+    return 0;
+}
+
+int
+inheritPriority(Pid pid, Priority priority) {
+    ProcessControlBlock *pcb;
+    if (!getProcessState(pid, &pcb))
+        return 1;
+
+    if (priority < pcb->priority)
+        applyPriority(pid, pcb, priority);
 
     return 0;
 }
 
+int
+restorePriority(Pid pid) {
+    ProcessControlBlock *pcb;
+    if (!getProcessState(pid, &pcb))
+        return 1;
+
+    applyPriority(pid, pcb, pcb->basePriority);
+    return 0;
+}
+
+Priority
+getPriority(Pid pid) {
+    ProcessControlBlock *pcb;
+    if (!getProcessState(pid, &pcb))
+        return PRIORITY_DEFAULT;
+
+    return pcb->priority;
+}
+
+int
+setRealTime(Pid pid, unsigned long period, unsigned long runtime, unsigned long deadline) {
+    ProcessControlBlock *pcb;
+    if (!getProcessState(pid, &pcb))
+        return 1;
+
+    // The process changes queues, so take it out while its class is decided.
+    int queued = pcb->status == READY;
+    if (queued)
+        dequeueProcess(pid);
+
+    int wasRealTime = isRealTimeProcess(pid);
+
+    unsigned long now = getElapsedTicks();
+    int result = period == 0 ? setRealTimeParameters(pid, 0, 0, 0, now)
+                             : setRealTimeParameters(pid, MILLISECONDS_TO_TICKS(period), MILLISECONDS_TO_TICKS(runtime),
+                                                     MILLISECONDS_TO_TICKS(deadline), now);
+
+    if (queued)
+        enqueueProcess(pid);
+
+    // A running process that changes class keeps running, so hand its accounting over to the new class.
+    if (pcb->status == RUNNING && wasRealTime != isRealTimeProcess(pid)) {
+        if (wasRealTime)
+            startSlice(pid);
+        else
+            endSlice(pid);
+    }
+
+    if (result == 0)
+        reschedulePending = 1;
+    return result;
+}
+
+int
+hasReadyProcesses() {
+    return hasReadyProcess() || peekRealTimeProcess(getElapsedTicks()) != NO_READY_PROCESS;
+}
+
+unsigned long
+getIdleTicks() {
+    unsigned long timerTicks = getTicksToNextTimer();
+    unsigned long releaseTicks = getTicksToNextRelease(getElapsedTicks());
+    if (timerTicks == 0 || (releaseTicks != 0 && releaseTicks < timerTicks))
+        return releaseTicks;
+    return timerTicks;
+}
+
 void
 yield() {
-    currentQuantum = 0;
+    sliceExpired = 1;
     int81();
 }
 
+void
+yieldTo(Pid pid) {
+    if (!isReadyProcess(pid) || !isRunningProcess(currentRunningPID) || isRealTimeProcess(pid) ||
+        isRealTimeProcess(currentRunningPID) || PCB(pid)->priority > PCB(currentRunningPID)->priority)
+        return;
+
+    handOffPid = pid;
+    sliceExpired = 1;
+    int81();
+}
+
+void
+reschedule() {
+    if (reschedulePending)
+        int81();
+}
+
+void *
+rescheduleFromInterrupt(void *currentRSP) {
+    return reschedulePending ? switchProcess(currentRSP) : currentRSP;
+}
+
 void *
 switchProcess(void *currentRSP) {
-    if (currentRunningPID >= 0) {
-        processTable[currentRunningPID].currentRSP = currentRSP;
-        if (processTable[currentRunningPID].status == RUNNING)
-            processTable[currentRunningPID].status = READY;
-    } else if (currentRunningPID == PSEUDOPID_KERNEL)
+    if (currentRunningPID >= 0)
+        PCB(currentRunningPID)->currentRSP = currentRSP;
+    else if (currentRunningPID == PSEUDOPID_KERNEL)
         mainRSP = currentRSP;
 
-    if (isReadyProcess(forceRunNextPID)) {
-        currentRunningPID = forceRunNextPID;
-        forceRunNextPID = PSEUDOPID_NONE;
-        currentQuantum = getCurrentQuantum(currentRunningPID);
-    } else if (!isReadyProcess(currentRunningPID) || currentQuantum == 0) {
-        currentRunningPID = getNextReadyPid();
-
-        if (currentRunningPID == PSEUDOPID_KERNEL) {
-            currentQuantum = 0;
+    Pid previousPid = currentRunningPID;
+    int preempted = isRunningProcess(previousPid) && !sliceExpired;
+
+    // An interrupt other than the tick may end a tickless idle period.
+    resumeTick();
+    unsigned long now = getElapsedTicks();
+    Pid realTimePid = peekRealTimeProcess(now);
+    Pid wokenPid = peekWake();
+    Pid handOffTarget = handOffPid;
+    handOffPid = PSEUDOPID_NONE;
+    reschedulePending = 0;
+
+    if (realTimePid == NO_READY_PROCESS && isReadyProcess(handOffTarget) && !isRealTimeProcess(handOffTarget)) {
+        donateSlice(currentRunningPID, handOffTarget);
+        stopCurrentProcess(now);
+        currentRunningPID = handOffTarget;
+        removeReadyProcess(currentRunningPID);
+        traceEvent(TRACE_HAND_OFF, currentRunningPID, previousPid);
+        countSwitch(previousPid, preempted);
+        startProcess(currentRunningPID, now);
+    } else if (realTimePid == NO_READY_PROCESS && wokenPid != PSEUDOPID_NONE && shouldWakePreempt(wokenPid)) {
+        stopCurrentProcess(now);
+        currentRunningPID = wokenPid;
+        removeReadyProcess(currentRunningPID);
+        traceEvent(TRACE_FORCE_RUN, currentRunningPID, previousPid);
+        countSwitch(previousPid, preempted);
+        startProcess(currentRunningPID, now);
+    } else if (!isRunningProcess(currentRunningPID) || sliceExpired || shouldPreemptCurrent(realTimePid, now)) {
+        stopCurrentProcess(now);
+        currentRunningPID = takeNextProcess(now);
+
+        if (currentRunningPID == NO_READY_PROCESS) {
+            currentRunningPID = PSEUDOPID_KERNEL;
+            countSwitch(previousPid, preempted);
+            sliceExpired = 0;
             return mainRSP;
         }
 
-        currentQuantum = getCurrentQuantum(currentRunningPID);
-    } else {
-        currentQuantum -= 1;
+        countSwitch(previousPid, preempted);
+        startProcess(currentRunningPID, now);
     }
 
-    processTable[currentRunningPID].status = RUNNING;
-    return processTable[currentRunningPID].currentRSP;
+    sliceExpired = 0;
+
+    PCB(currentRunningPID)->status = RUNNING;
+    return PCB(currentRunningPID)->currentRSP;
 }
 
 int
@@ -200,13 +571,26 @@ getProcessInfo(Pid pid, ProcessInfo *processInfo) {
     processInfo->status = pcb->status;
     processInfo->priority = pcb->priority;
     processInfo->currentRSP = pcb->currentRSP;
+
+    // The slice or wait in progress has not been accounted yet.
+    unsigned long now = getElapsedTicks();
+    int isRunning = pid == currentRunningPID && pcb->status == RUNNING;
+    unsigned long runTicks = pcb->runTicks + (isRunning ? now - pcb->lastRunTicks : 0);
+    unsigned long waitTicks = pcb->waitTicks + (pcb->status == READY ? now - pcb->readySinceTicks : 0);
+
+    processInfo->startTime = TICKS_TO_MILLISECONDS(pcb->createdTicks);
+    processInfo->cpuTime = TICKS_TO_MILLISECONDS(runTicks);
+    processInfo->waitTime = TICKS_TO_MILLISECONDS(waitTicks);
+    processInfo->lastRunTime = TICKS_TO_MILLISECONDS(isRunning ? now : pcb->lastRunTicks);
+    processInfo->voluntarySwitches = pcb->voluntarySwitches;
+    processInfo->involuntarySwitches = pcb->involuntarySwitches;
     return 0;
 }
 
 static ProcessControlBlock *
 getCurrentProcess() {
-    if (currentRunningPID > 0 && processTable[currentRunningPID].status == RUNNING)
-        return &processTable[currentRunningPID];
+    if (currentRunningPID > 0 && PCB(currentRunningPID)->status == RUNNING)
+        return PCB(currentRunningPID);
 
     return NULL;
 }
@@ -218,9 +602,10 @@ killCurrentProcess() {
     if (currentProcess == NULL)
         return 1;
 
-    currentProcess->status = KILLED;
-    currentProcess->currentRSP = NULL;
-    kill(currentRunningPID);
+    // The scheduler state of the process is released before the process itself, which marks it as killed.
+    Pid pid = currentRunningPID;
+    onProcessKilled(pid);
+    kill(pid);
 
     return 0;
 }
\ No newline at end of file
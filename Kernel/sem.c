@@ -4,17 +4,27 @@
 #include <namer.h>
 #include <scheduler.h>
 #include <sem.h>
+#include <slab.h>
 #include <string.h>
 #include <waitingQueue.h>
 
+#define NO_OWNER -1
+
+/*
+ * Semaphores created with an initial value of 1 work as mutexes: the process holding it is tracked, and it inherits
+ * the priority of any higher-priority process waiting on it until it posts.
+ */
 typedef struct {
     uint8_t value;
     Lock lock;
     uint8_t linkedProcesses;
+    uint8_t isMutex;
+    Pid owner;
     const char *name;
     WaitingQueue processesWQ;
 } Semaphore;
 
+static ObjectCache semaphoreCache = OBJECT_CACHE(Semaphore, NULL);
 static Semaphore *semaphores[MAX_SEMAPHORES] = {NULL};
 static Namer namer;
 static Lock generalLock;
@@ -29,7 +39,7 @@ static int
 freeSem(Sem sem) {
     int value = deleteResource(namer, semaphores[sem]->name) == NULL;
     value += freeQueue(semaphores[sem]->processesWQ);
-    value += free(semaphores[sem]);
+    value += freeObject(&semaphoreCache, semaphores[sem]);
     semaphores[sem] = NULL;
     if (value != 0)
         return SEM_FAIL;
@@ -86,25 +96,27 @@ openSem(const char *name, uint8_t initialValue) {
         return SEM_FAIL;
     }
 
-    semaphores[i] = malloc(sizeof(Semaphore));
+    semaphores[i] = allocateObject(&semaphoreCache);
     if (semaphores[i] == NULL) {
         unlock(&generalLock);
         return SEM_FAIL;
     }
     semaphores[i]->value = initialValue;
+    semaphores[i]->isMutex = initialValue == 1;
+    semaphores[i]->owner = NO_OWNER;
     unlock(&semaphores[i]->lock);
     semaphores[i]->linkedProcesses = 1;
     semaphores[i]->processesWQ = newQueue();
 
     if (semaphores[i]->processesWQ == NULL) {
-        free(semaphores[i]);
+        freeObject(&semaphoreCache, semaphores[i]);
         unlock(&generalLock);
         return SEM_FAIL;
     }
 
     if (addResource(namer, (void *) (int64_t) i, name, &(semaphores[i]->name)) != 0) {
         freeQueue(semaphores[i]->processesWQ);
-        free(semaphores[i]);
+        freeObject(&semaphoreCache, semaphores[i]);
         semaphores[i] = NULL;
         unlock(&generalLock);
         return SEM_FAIL;
@@ -138,9 +150,17 @@ post(Sem sem) {
     }
 
     semaphores[sem]->value++;
+
+    if (semaphores[sem]->owner != NO_OWNER) {
+        restorePriority(semaphores[sem]->owner);
+        semaphores[sem]->owner = NO_OWNER;
+    }
+
+    Pid woken = peekInQueue(semaphores[sem]->processesWQ);
     unblockInQueue(semaphores[sem]->processesWQ);
 
     unlock(&semaphores[sem]->lock);
+    yieldTo(woken);
     return SEM_OK;
 }
 
@@ -154,6 +174,9 @@ wait(Sem sem) {
     Pid cpid = getpid();
 
     while (semaphores[sem]->value == 0) {
+        if (semaphores[sem]->owner != NO_OWNER)
+            inheritPriority(semaphores[sem]->owner, getPriority(cpid));
+
         addInQueue(semaphores[sem]->processesWQ, cpid);
         unlock(&semaphores[sem]->lock);
         block(cpid);
@@ -162,6 +185,10 @@ wait(Sem sem) {
     }
 
     semaphores[sem]->value--;
+
+    if (semaphores[sem]->isMutex && semaphores[sem]->value == 0)
+        semaphores[sem]->owner = cpid;
+
     unlock(&semaphores[sem]->lock);
     return SEM_OK;
 }
@@ -0,0 +1,42 @@
+#include <defs.h>
+#include <lib.h>
+#include <serial.h>
+
+#define COM1 0x3F8
+
+// Registers, as offsets from the base port
+#define DATA              0
+#define INTERRUPT_ENABLE  1
+#define DIVISOR_LOW       0
+#define DIVISOR_HIGH      1
+#define FIFO_CONTROL      2
+#define LINE_CONTROL      3
+#define MODEM_CONTROL     4
+#define LINE_STATUS       5
+#define TRANSMITTER_EMPTY 0x20
+
+#define FIFO_SIZE 16
+
+void
+initializeSerial() {
+    outb(COM1 + INTERRUPT_ENABLE, 0x00);  // No interrupts, the port is polled
+    outb(COM1 + LINE_CONTROL, 0x80);      // Enable the divisor latch
+    outb(COM1 + DIVISOR_LOW, 0x01);       // 115200 baud
+    outb(COM1 + DIVISOR_HIGH, 0x00);
+    outb(COM1 + LINE_CONTROL, 0x03);      // 8 bits, no parity, one stop bit
+    outb(COM1 + FIFO_CONTROL, 0xC7);      // Enable and clear the FIFOs
+    outb(COM1 + MODEM_CONTROL, 0x03);     // DTR and RTS
+}
+
+int
+trySerialWrite(const char *buffer, int length) {
+    if ((inb(COM1 + LINE_STATUS) & TRANSMITTER_EMPTY) == 0)
+        return 0;
+
+    // The transmitter FIFO is empty, so it can take a whole FIFO worth of characters.
+    int written;
+    for (written = 0; written < length && written < FIFO_SIZE; written++)
+        outb(COM1 + DATA, buffer[written]);
+
+    return written;
+}
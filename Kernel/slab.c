@@ -0,0 +1,160 @@
+#include <defs.h>
+#include <frameAllocator.h>
+#include <lib.h>
+#include <slab.h>
+
+// Page frames set aside for slabs at boot, before the memory manager takes the rest
+#define SLAB_POOL_FRAMES 256
+
+// Every object is preceded by a slot header, so the object itself is left untouched while it is free.
+typedef union ObjectSlot {
+    struct Slab *slab;           // While the object is in use
+    union ObjectSlot *nextFree;  // While the object is free
+} ObjectSlot;
+
+typedef struct Slab {
+    ObjectCache *cache;
+    struct Slab *previous;
+    struct Slab *next;
+    ObjectSlot *freeSlots;
+    unsigned int usedObjects;
+} Slab;
+
+#define SLOT_SIZE(cache)        WORD_ALIGN_UP(sizeof(ObjectSlot) + (cache)->objectSize)
+#define FIRST_SLOT_OFFSET       WORD_ALIGN_UP(sizeof(Slab))
+#define OBJECTS_PER_SLAB(cache) ((SLAB_SIZE - FIRST_SLOT_OFFSET) / SLOT_SIZE(cache))
+#define SLAB_OF(address)        ((Slab *) ((uint64_t) (address) & ~(uint64_t) (SLAB_SIZE - 1)))
+
+// Free slabs are linked through their first bytes.
+typedef struct FreeSlab {
+    struct FreeSlab *next;
+} FreeSlab;
+
+static FreeSlab *freeSlabs = NULL;
+
+void
+initializeSlabs() {
+    void *frames = allocateFrames(SLAB_POOL_FRAMES);
+    if (frames == NULL)
+        return;
+
+    for (int i = SLAB_POOL_FRAMES - 1; i >= 0; i--) {
+        FreeSlab *slab = frames + i * SLAB_SIZE;
+        slab->next = freeSlabs;
+        freeSlabs = slab;
+    }
+}
+
+static void *
+takeSlab() {
+    FreeSlab *slab = freeSlabs;
+    if (slab != NULL)
+        freeSlabs = slab->next;
+    return slab;
+}
+
+static void
+releaseSlab(void *address) {
+    FreeSlab *slab = address;
+    slab->next = freeSlabs;
+    freeSlabs = slab;
+}
+
+static void
+pushPartialSlab(ObjectCache *cache, Slab *slab) {
+    slab->previous = NULL;
+    slab->next = cache->partialSlabs;
+    if (slab->next != NULL)
+        slab->next->previous = slab;
+    cache->partialSlabs = slab;
+}
+
+static void
+removePartialSlab(ObjectCache *cache, Slab *slab) {
+    if (slab->previous == NULL)
+        cache->partialSlabs = slab->next;
+    else
+        slab->previous->next = slab->next;
+
+    if (slab->next != NULL)
+        slab->next->previous = slab->previous;
+}
+
+static Slab *
+newSlab(ObjectCache *cache) {
+    unsigned int objects = OBJECTS_PER_SLAB(cache);
+    Slab *slab;
+    if (objects == 0 || (slab = takeSlab()) == NULL)
+        return NULL;
+
+    slab->cache = cache;
+    slab->freeSlots = NULL;
+    slab->usedObjects = 0;
+
+    // Link the slots backwards so objects are handed out in address order.
+    for (unsigned int i = objects; i > 0; i--) {
+        ObjectSlot *slot = (void *) slab + FIRST_SLOT_OFFSET + (i - 1) * SLOT_SIZE(cache);
+        if (cache->constructor != NULL)
+            cache->constructor(slot + 1);
+        slot->nextFree = slab->freeSlots;
+        slab->freeSlots = slot;
+    }
+
+    return slab;
+}
+
+void *
+allocateObject(ObjectCache *cache) {
+    Slab *slab = cache->partialSlabs;
+    if (slab == NULL) {
+        if (cache->emptySlab != NULL) {
+            slab = cache->emptySlab;
+            cache->emptySlab = NULL;
+        } else if ((slab = newSlab(cache)) == NULL) {
+            return NULL;
+        }
+        pushPartialSlab(cache, slab);
+    }
+
+    ObjectSlot *slot = slab->freeSlots;
+    slab->freeSlots = slot->nextFree;
+    slab->usedObjects++;
+    slot->slab = slab;
+
+    // Full slabs are in no list until one of their objects is freed.
+    if (slab->freeSlots == NULL)
+        removePartialSlab(cache, slab);
+
+    return slot + 1;
+}
+
+int
+freeObject(ObjectCache *cache, void *object) {
+    if (object == NULL)
+        return 0;
+
+    // The object must start a slot of a slab of this cache, and be in use: a free slot links to another slot or NULL.
+    ObjectSlot *slot = (ObjectSlot *) object - 1;
+    Slab *slab = SLAB_OF(slot);
+    size_t offset = (void *) slot - (void *) slab;
+    if (slab->cache != cache || offset < FIRST_SLOT_OFFSET || (offset - FIRST_SLOT_OFFSET) % SLOT_SIZE(cache) != 0 ||
+        (offset - FIRST_SLOT_OFFSET) / SLOT_SIZE(cache) >= OBJECTS_PER_SLAB(cache) || slot->slab != slab)
+        return 1;
+
+    if (slab->freeSlots == NULL)
+        pushPartialSlab(cache, slab);
+
+    slot->nextFree = slab->freeSlots;
+    slab->freeSlots = slot;
+    slab->usedObjects--;
+
+    if (slab->usedObjects == 0) {
+        removePartialSlab(cache, slab);
+        if (cache->emptySlab == NULL)
+            cache->emptySlab = slab;
+        else
+            releaseSlab(slab);
+    }
+
+    return 0;
+}
@@ -0,0 +1,92 @@
+#include <apic.h>
+#include <defs.h>
+#include <memoryManager.h>
+#include <smp.h>
+
+#define AP_STACK_SIZE   0x4000
+#define AP_START_VECTOR 0x82
+
+typedef struct Cpu {
+    struct Cpu *self;  // Must be the first field, so gs:0 holds the address of the data
+    int index;
+    uint8_t apicId;
+    volatile int online;
+    void *stack;
+} Cpu;
+
+// Pure64 records the APIC ID of every detected CPU, how many there are, and which APs it started.
+static const uint8_t *const detectedApicIds = (uint8_t *) 0x5100;
+static const uint16_t *const detectedCpus = (uint16_t *) 0x5B04;
+static const uint8_t *const startedApicIds = (uint8_t *) 0x5700;
+
+static Cpu cpus[MAX_CPUS];
+static int cpuCount = 0;
+
+extern void setCpuBase(Cpu *cpu);
+
+static Cpu *
+findCpu(uint8_t apicId) {
+    for (int i = 0; i < cpuCount; i++)
+        if (cpus[i].apicId == apicId)
+            return &cpus[i];
+    return NULL;
+}
+
+static Cpu *
+addCpu(uint8_t apicId, void *stack) {
+    Cpu *cpu = &cpus[cpuCount];
+    cpu->self = cpu;
+    cpu->index = cpuCount;
+    cpu->apicId = apicId;
+    cpu->online = 0;
+    cpu->stack = stack;
+    cpuCount++;
+    return cpu;
+}
+
+void
+initializeSmp() {
+    Cpu *bsp = addCpu(hasLocalApic() ? getLocalApicId() : 0, NULL);
+    setCpuBase(bsp);
+    bsp->online = 1;
+
+    if (!hasLocalApic())
+        return;
+
+    for (int i = 0; i < *detectedCpus && cpuCount < MAX_CPUS; i++) {
+        uint8_t apicId = detectedApicIds[i];
+        if (apicId == bsp->apicId || !startedApicIds[apicId])
+            continue;
+
+        void *stack = malloc(AP_STACK_SIZE);
+        if (stack == NULL)
+            break;
+
+        addCpu(apicId, stack);
+    }
+
+    // Every AP must be known before the first one wakes up, as they look themselves up in cpus.
+    for (int i = 1; i < cpuCount; i++)
+        sendIpi(cpus[i].apicId, AP_START_VECTOR);
+}
+
+void *
+getApStack() {
+    acknowledgeLocalApic();
+
+    Cpu *cpu = findCpu(getLocalApicId());
+    if (cpu == NULL || cpu->stack == NULL)
+        return NULL;
+
+    return (void *) (((uint64_t) cpu->stack + AP_STACK_SIZE) & ~(uint64_t) 0x0F);
+}
+
+void
+apMain() {
+    Cpu *cpu = findCpu(getLocalApicId());
+    setCpuBase(cpu);
+    cpu->online = 1;
+
+    // The interrupt handlers assume a single CPU, so the AP goes back to apStartHandler to be parked with interrupts
+    // disabled.
+}
@@ -8,6 +8,8 @@
 #include <scheduler.h>
 #include <sem.h>
 #include <time.h>
+#include <timerWheel.h>
+#include <trace.h>
 
 typedef size_t (*SyscallHandlerFunction)(size_t rdi, size_t rsi, size_t rdx, size_t r10, size_t r8);
 
@@ -56,6 +58,23 @@ dateHandler(char *buffer) {
     return 0;
 }
 
+static int
+sleepHandler(unsigned long millis) {
+    Pid pid = getpid();
+
+    if (millis == 0) {
+        yield();
+        return 0;
+    }
+
+    if (addSleeper(pid, MILLISECONDS_TO_TICKS(millis)) != 0)
+        return 1;
+
+    block(pid);
+    yield();
+    return 0;
+}
+
 static void *
 mallocHandler(size_t size) {
     return handleMalloc(getpid(), size);
@@ -146,8 +165,8 @@ priorityHandler(Pid pid, Priority priority) {
 }
 
 static int
-listProcessesHandler(ProcessInfo *array, int maxProcesses) {
-    return listProcesses(array, maxProcesses);
+listProcessesHandler(ProcessInfo *array, int maxProcesses, unsigned int *cursor) {
+    return listProcesses(array, maxProcesses, cursor);
 }
 
 static int
@@ -161,6 +180,22 @@ waitpidHandler(Pid pid) {
     return 0;
 }
 
+static int
+readTraceHandler(TraceEvent *array, int maxEvents, unsigned long *cursor) {
+    return readTrace(array, maxEvents, cursor);
+}
+
+static int
+traceStreamingHandler(int enabled) {
+    setTraceStreaming(enabled);
+    return 0;
+}
+
+static int
+realTimeHandler(Pid pid, unsigned long period, unsigned long runtime, unsigned long deadline) {
+    return setRealTime(pid, period, runtime, deadline);
+}
+
 static int
 createPipeHandler(int pipefd[2]) {
     Pid pid = getpid();
@@ -253,7 +288,8 @@ static SyscallHandlerFunction syscallHandlers[] = {
     /* 0x20 */ (SyscallHandlerFunction) millisHandler,
     /* 0x21 */ (SyscallHandlerFunction) timeHandler,
     /* 0x22 */ (SyscallHandlerFunction) dateHandler,
-    /* 0x23 -> 0x2F */ NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
+    /* 0x23 */ (SyscallHandlerFunction) sleepHandler,
+    /* 0x24 -> 0x2F */ NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
 
     /* Memory management syscalls */
     /* 0x30 */ (SyscallHandlerFunction) mallocHandler,
@@ -273,7 +309,10 @@ static SyscallHandlerFunction syscallHandlers[] = {
     /* 0x47 */ (SyscallHandlerFunction) priorityHandler,
     /* 0x48 */ (SyscallHandlerFunction) listProcessesHandler,
     /* 0x49 */ (SyscallHandlerFunction) waitpidHandler,
-    /* 0x4A -> 0x4F */ NULL, NULL, NULL, NULL, NULL, NULL,
+    /* 0x4A */ (SyscallHandlerFunction) readTraceHandler,
+    /* 0x4B */ (SyscallHandlerFunction) traceStreamingHandler,
+    /* 0x4C */ (SyscallHandlerFunction) realTimeHandler,
+    /* 0x4D -> 0x4F */ NULL, NULL, NULL,
 
     /* Pipe syscalls */
     /* 0x50 */ (SyscallHandlerFunction) createPipeHandler,
@@ -293,7 +332,10 @@ static SyscallHandlerFunction syscallHandlers[] = {
 size_t
 syscallDispatcher(size_t rdi, size_t rsi, size_t rdx, size_t r10, size_t r8, size_t rax) {
     SyscallHandlerFunction handler;
-    if (rax < (sizeof(syscallHandlers) / sizeof(syscallHandlers[0])) && (handler = syscallHandlers[rax]) != NULL)
-        return handler(rdi, rsi, rdx, r10, r8);
-    return -1;
+    if (rax >= (sizeof(syscallHandlers) / sizeof(syscallHandlers[0])) || (handler = syscallHandlers[rax]) == NULL)
+        return -1;
+
+    size_t result = handler(rdi, rsi, rdx, r10, r8);
+    reschedule();
+    return result;
 }
\ No newline at end of file
@@ -1,6 +1,10 @@
+#include <apic.h>
 #include <defs.h>
+#include <interrupts.h>
 #include <lib.h>
 #include <time.h>
+#include <timerWheel.h>
+#include <trace.h>
 
 #define SECONDS 0x00
 #define MINUTES 0x02
@@ -9,13 +13,159 @@
 #define MONTH   0x08
 #define YEAR    0x09
 
+// PIT channel 0 counts at 1193182 Hz, and its reload value is 16 bits wide (0 stands for 65536).
+#define PIT_FREQUENCY     1193182
+#define PIT_MAX_COUNTS    65536
+#define PIT_MODE_PERIODIC 0x34
+#define PIT_MODE_ONE_SHOT 0x30
+
+#if TICK_FREQUENCY < (PIT_FREQUENCY / PIT_MAX_COUNTS + 1)
+#error "TICK_FREQUENCY is too low for the PIT"
+#endif
+
+// Local APIC timer registers. The timer is delivered on the PIT's vector.
+#define LAPIC_LVT_TIMER          0x320
+#define LAPIC_TIMER_INITIAL      0x380
+#define LAPIC_TIMER_CURRENT      0x390
+#define LAPIC_TIMER_DIVIDE       0x3E0
+#define LAPIC_TIMER_DIVIDE_BY_16 0x03
+#define LAPIC_TIMER_PERIODIC     (1 << 17)
+#define LAPIC_TIMER_MASKED       (1 << 16)
+#define LAPIC_TIMER_VECTOR       0x20
+#define LAPIC_MAX_COUNTS         0xFFFFFFFFUL
+
+// The LAPIC timer frequency is unknown, so it is measured against the PIT for 1/CALIBRATION_FREQUENCY seconds.
+#define CALIBRATION_FREQUENCY 100
+
 extern uint8_t readValue(uint8_t mode);
+extern void setTimerCounter(uint8_t mode, uint16_t count);
+extern uint16_t getTimerCounter();
+
+static int useLocalApic = 0;
+static unsigned long countsPerTick;
+static unsigned long maxCounts;
 
 static unsigned long ticks = 0;
 
+// While idle, the periodic tick is replaced by a single interrupt oneShotCounts later.
+static int tickStopped = 0;
+static unsigned long oneShotCounts;
+static unsigned long carriedCounts = 0;
+
+static void
+startTimer(unsigned long counts, int periodic) {
+    if (useLocalApic) {
+        writeLocalApic(LAPIC_LVT_TIMER, LAPIC_TIMER_VECTOR | (periodic ? LAPIC_TIMER_PERIODIC : 0));
+        writeLocalApic(LAPIC_TIMER_INITIAL, (uint32_t) counts);
+    } else
+        setTimerCounter(periodic ? PIT_MODE_PERIODIC : PIT_MODE_ONE_SHOT, (uint16_t) counts);
+}
+
+static unsigned long
+getRemainingCounts() {
+    return useLocalApic ? readLocalApic(LAPIC_TIMER_CURRENT) : getTimerCounter();
+}
+
+static unsigned long
+calibrateLocalApic() {
+    writeLocalApic(LAPIC_TIMER_DIVIDE, LAPIC_TIMER_DIVIDE_BY_16);
+    writeLocalApic(LAPIC_LVT_TIMER, LAPIC_TIMER_VECTOR | LAPIC_TIMER_MASKED);
+
+    // The new count is only loaded on the next PIT clock, so wait until it reads back before starting the window.
+    uint16_t reload = PIT_FREQUENCY / CALIBRATION_FREQUENCY, start;
+    setTimerCounter(PIT_MODE_ONE_SHOT, reload);
+    while ((start = getTimerCounter()) == 0 || start > reload)
+        ;
+    writeLocalApic(LAPIC_TIMER_INITIAL, LAPIC_MAX_COUNTS);
+
+    // After its terminal count the PIT counter wraps around to 0xFFFF, which is how the end is detected.
+    uint16_t last = start, current;
+    while ((current = getTimerCounter()) <= last)
+        last = current;
+
+    unsigned long elapsed = LAPIC_MAX_COUNTS - readLocalApic(LAPIC_TIMER_CURRENT);
+    writeLocalApic(LAPIC_TIMER_INITIAL, 0);
+    return elapsed * PIT_FREQUENCY / ((unsigned long) start * TICK_FREQUENCY);
+}
+
+static void
+startPeriodicTick() {
+    startTimer(countsPerTick, 1);
+    tickStopped = 0;
+}
+
+static void
+addElapsedCounts(unsigned long counts) {
+    counts += carriedCounts;
+    ticks += counts / countsPerTick;
+    carriedCounts = counts % countsPerTick;
+}
+
+void
+initializeTimer() {
+    if (hasLocalApic()) {
+        countsPerTick = calibrateLocalApic();
+        maxCounts = LAPIC_MAX_COUNTS;
+
+        // 1111 1101 keyboard only, the tick now comes from the Local APIC
+        useLocalApic = countsPerTick != 0;
+        if (useLocalApic)
+            picMasterMask(0xFD);
+    }
+
+    if (!useLocalApic) {
+        countsPerTick = PIT_FREQUENCY / TICK_FREQUENCY;
+        maxCounts = PIT_MAX_COUNTS;
+    }
+
+    startPeriodicTick();
+}
+
 void
 interruptHandlerRTC() {
-    ticks++;
+    if (useLocalApic)
+        acknowledgeLocalApic();
+
+    if (tickStopped) {
+        addElapsedCounts(oneShotCounts);
+        startPeriodicTick();
+    } else
+        ticks++;
+
+    advanceTimerWheel(ticks);
+    streamTrace();
+}
+
+void
+idleTickless(unsigned long wakeupTicks) {
+    unsigned long maxTicks = maxCounts / countsPerTick;
+    if (wakeupTicks == 0 || wakeupTicks > maxTicks)
+        wakeupTicks = maxTicks;
+
+    oneShotCounts = wakeupTicks * countsPerTick;
+    tickStopped = 1;
+    startTimer(oneShotCounts, 0);
+
+    hlt();
+    cli();
+    resumeTick();
+}
+
+void
+resumeTick() {
+    if (!tickStopped)
+        return;
+
+    // Woken up by another device before the one-shot interrupt was taken: account the time spent halted. If the
+    // one-shot already ran out (the PIT wraps around past 0), its interrupt is still pending and will count the last
+    // tick itself once the periodic tick is back.
+    unsigned long remaining = getRemainingCounts();
+    if (remaining == 0 || remaining > oneShotCounts)
+        addElapsedCounts(oneShotCounts - countsPerTick);
+    else
+        addElapsedCounts(oneShotCounts - remaining);
+    startPeriodicTick();
+    advanceTimerWheel(ticks);
 }
 
 unsigned long
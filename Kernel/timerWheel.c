@@ -0,0 +1,166 @@
+#include <defs.h>
+#include <lib.h>
+#include <memoryManager.h>
+#include <process.h>
+#include <scheduler.h>
+#include <timerWheel.h>
+
+/*
+ * Hierarchical timer wheel. Level 0 has one bucket per tick for the next WHEEL_SLOTS ticks, and every level above
+ * covers WHEEL_SLOTS times the range of the previous one. Timers in upper levels are moved down (cascaded) when
+ * the lower level wraps around, so arming, cancelling and expiring a timer are all O(1).
+ */
+#define WHEEL_LEVELS       5
+#define WHEEL_SLOT_BITS    6
+#define WHEEL_SLOTS        (1 << WHEEL_SLOT_BITS)
+#define WHEEL_SLOT_MASK    (WHEEL_SLOTS - 1)
+#define LEVEL_SHIFT(level) ((level) * WHEEL_SLOT_BITS)
+#define MAX_TIMER_TICKS    ((1UL << LEVEL_SHIFT(WHEEL_LEVELS)) - 1)
+
+#define NO_BUCKET -1
+#define NO_TIMER  -1
+#define NODE(pid) (&nodes[PID_TO_SLOT(pid)])
+
+typedef struct {
+    unsigned long expires;
+    int bucket;
+    Pid previous;
+    Pid next;
+} TimerNode;
+
+static TimerNode *nodes = NULL;
+static unsigned int nodesSize = 0;
+static Pid buckets[WHEEL_LEVELS * WHEEL_SLOTS];
+static unsigned long wheelTicks;
+static unsigned int armedTimers;
+
+static void
+linkTimer(Pid pid) {
+    TimerNode *node = NODE(pid);
+    unsigned long delta = node->expires - wheelTicks;
+
+    int level = 0;
+    while (level < WHEEL_LEVELS - 1 && delta >= (1UL << LEVEL_SHIFT(level + 1)))
+        level++;
+
+    int bucket = level * WHEEL_SLOTS + ((node->expires >> LEVEL_SHIFT(level)) & WHEEL_SLOT_MASK);
+
+    node->bucket = bucket;
+    armedTimers++;
+    node->previous = NO_TIMER;
+    node->next = buckets[bucket];
+    if (node->next != NO_TIMER)
+        NODE(node->next)->previous = pid;
+    buckets[bucket] = pid;
+}
+
+static void
+unlinkTimer(Pid pid) {
+    TimerNode *node = NODE(pid);
+
+    if (node->previous == NO_TIMER)
+        buckets[node->bucket] = node->next;
+    else
+        NODE(node->previous)->next = node->next;
+
+    if (node->next != NO_TIMER)
+        NODE(node->next)->previous = node->previous;
+
+    node->bucket = NO_BUCKET;
+    armedTimers--;
+}
+
+static void
+cascade(int level) {
+    int bucket = level * WHEEL_SLOTS + ((wheelTicks >> LEVEL_SHIFT(level)) & WHEEL_SLOT_MASK);
+    Pid pid = buckets[bucket];
+    buckets[bucket] = NO_TIMER;
+
+    while (pid != NO_TIMER) {
+        Pid next = NODE(pid)->next;
+        armedTimers--;
+        linkTimer(pid);
+        pid = next;
+    }
+}
+
+void
+initializeTimerWheel() {
+    for (int i = 0; i < WHEEL_LEVELS * WHEEL_SLOTS; i++)
+        buckets[i] = NO_TIMER;
+    wheelTicks = 0;
+    armedTimers = 0;
+}
+
+int
+resizeTimerWheel(unsigned int size) {
+    if (size <= nodesSize)
+        return 0;
+
+    TimerNode *newNodes = realloc(nodes, size * sizeof(TimerNode));
+    if (newNodes == NULL)
+        return 1;
+
+    for (unsigned int i = nodesSize; i < size; i++)
+        newNodes[i].bucket = NO_BUCKET;
+
+    nodes = newNodes;
+    nodesSize = size;
+    return 0;
+}
+
+int
+addSleeper(Pid pid, unsigned long ticks) {
+    if (pid < 0 || PID_TO_SLOT(pid) >= nodesSize)
+        return 1;
+
+    cancelSleeper(pid);
+
+    if (ticks == 0)
+        ticks = 1;
+    else if (ticks > MAX_TIMER_TICKS)
+        ticks = MAX_TIMER_TICKS;
+
+    NODE(pid)->expires = wheelTicks + ticks;
+    linkTimer(pid);
+    return 0;
+}
+
+void
+cancelSleeper(Pid pid) {
+    if (pid >= 0 && PID_TO_SLOT(pid) < nodesSize && NODE(pid)->bucket != NO_BUCKET)
+        unlinkTimer(pid);
+}
+
+unsigned long
+getTicksToNextTimer() {
+    if (armedTimers == 0)
+        return 0;
+
+    // Timers in upper levels are only looked at when level 0 wraps around, so stop there at the latest.
+    for (unsigned long delta = 1; delta < WHEEL_SLOTS; delta++) {
+        unsigned long tick = wheelTicks + delta;
+        if ((tick & WHEEL_SLOT_MASK) == 0 || buckets[tick & WHEEL_SLOT_MASK] != NO_TIMER)
+            return delta;
+    }
+
+    return WHEEL_SLOTS;
+}
+
+void
+advanceTimerWheel(unsigned long now) {
+    while (wheelTicks != now) {
+        wheelTicks++;
+
+        // When a level wraps around, bring down the timers of the next bucket of the level above.
+        for (int level = 1; level < WHEEL_LEVELS && (wheelTicks & ((1UL << LEVEL_SHIFT(level)) - 1)) == 0; level++)
+            cascade(level);
+
+        int bucket = wheelTicks & WHEEL_SLOT_MASK;
+        Pid pid;
+        while ((pid = buckets[bucket]) != NO_TIMER) {
+            unlinkTimer(pid);
+            unblock(pid);
+        }
+    }
+}
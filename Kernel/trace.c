@@ -0,0 +1,119 @@
+#include <defs.h>
+#include <lib.h>
+#include <serial.h>
+#include <trace.h>
+
+#define TRACE_MASK       (TRACE_BUFFER_SIZE - 1)
+#define MAX_LINE_LENGTH  64
+#define MAX_DIGITS       20
+
+static TraceEvent events[TRACE_BUFFER_SIZE];
+
+// Position of the next event to record. Events [head - TRACE_BUFFER_SIZE, head) are still in the buffer.
+static unsigned long head = 0;
+
+static int streaming = 0;
+static unsigned long streamCursor;
+static char line[MAX_LINE_LENGTH];
+static int linePosition = 0;
+static int lineLength = 0;
+
+static const char *eventNames[] = {"switch-out", "switch-in", "block", "unblock", "force-run", "create", "kill", "hand-off"};
+
+static int
+appendString(int length, const char *s) {
+    while (*s != '\0')
+        line[length++] = *s++;
+    return length;
+}
+
+static int
+appendNumber(int length, int64_t value, uint32_t base) {
+    char digits[MAX_DIGITS + 1];
+
+    if (value < 0) {
+        line[length++] = '-';
+        value = -value;
+    }
+
+    uintToBase((uint64_t) value, digits, base);
+    return appendString(length, digits);
+}
+
+static void
+formatNextLine() {
+    int length = 0;
+
+    if (head - streamCursor > TRACE_BUFFER_SIZE) {
+        length = appendString(length, "# lost ");
+        length = appendNumber(length, head - streamCursor - TRACE_BUFFER_SIZE, 10);
+        streamCursor = head - TRACE_BUFFER_SIZE;
+    } else {
+        TraceEvent *event = &events[streamCursor & TRACE_MASK];
+        length = appendNumber(length, event->timestamp, 16);
+        line[length++] = ' ';
+        length = appendString(length, eventNames[event->type]);
+        line[length++] = ' ';
+        length = appendNumber(length, event->pid, 10);
+        line[length++] = ' ';
+        length = appendNumber(length, event->other, 10);
+        streamCursor++;
+    }
+
+    line[length++] = '\n';
+    lineLength = length;
+    linePosition = 0;
+}
+
+void
+traceEvent(TraceEventType type, Pid pid, Pid other) {
+    TraceEvent *event = &events[head & TRACE_MASK];
+    event->timestamp = readTimestampCounter();
+    event->type = type;
+    event->pid = pid;
+    event->other = other;
+    head++;
+}
+
+int
+readTrace(TraceEvent *array, int maxEvents, unsigned long *cursor) {
+    if (head - *cursor > TRACE_BUFFER_SIZE)
+        *cursor = head > TRACE_BUFFER_SIZE ? head - TRACE_BUFFER_SIZE : 0;
+
+    int count = 0;
+    while (count < maxEvents && *cursor < head)
+        array[count++] = events[(*cursor)++ & TRACE_MASK];
+
+    return count;
+}
+
+void
+setTraceStreaming(int enabled) {
+    if (enabled && !streaming) {
+        streamCursor = head;
+        linePosition = 0;
+        lineLength = 0;
+    }
+
+    streaming = enabled;
+}
+
+void
+streamTrace() {
+    if (!streaming)
+        return;
+
+    while (1) {
+        if (linePosition == lineLength) {
+            if (streamCursor == head)
+                return;
+            formatNextLine();
+        }
+
+        int written = trySerialWrite(line + linePosition, lineLength - linePosition);
+        if (written == 0)
+            return;
+
+        linePosition += written;
+    }
+}
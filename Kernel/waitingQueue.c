@@ -2,6 +2,7 @@
 #include <lib.h>
 #include <memoryManager.h>
 #include <scheduler.h>
+#include <slab.h>
 #include <waitingQueue.h>
 
 #define BUFFER_CHUNK_SIZE 8
@@ -13,22 +14,27 @@ struct WaitingQueueData {
     unsigned int bufSize;
 };
 
+static void
+resetQueue(void *queue) {
+    WaitingQueue waitingQueue = queue;
+    waitingQueue->buf = NULL;
+    waitingQueue->offset = 0;
+    waitingQueue->count = 0;
+    waitingQueue->bufSize = 0;
+}
+
+static ObjectCache queueCache = OBJECT_CACHE(struct WaitingQueueData, resetQueue);
+
 WaitingQueue
 newQueue() {
-    WaitingQueue queue;
-    if ((queue = malloc(sizeof(struct WaitingQueueData))) == NULL)
-        return NULL;
-
-    queue->buf = NULL;
-    queue->offset = 0;
-    queue->count = 0;
-    queue->bufSize = 0;
-    return queue;
+    return allocateObject(&queueCache);
 }
 
 int
 freeQueue(WaitingQueue queue) {
-    return free(queue->buf) + free(queue);
+    int result = free(queue->buf);
+    resetQueue(queue);
+    return result + freeObject(&queueCache, queue);
 }
 
 int
@@ -63,6 +69,11 @@ entriesInQueue(WaitingQueue queue) {
     return queue->count;
 }
 
+Pid
+peekInQueue(WaitingQueue queue) {
+    return queue->count == 0 ? -1 : queue->buf[queue->offset];
+}
+
 int
 containsInQueue(WaitingQueue queue, Pid pid) {
     for (unsigned int i = 0; i < queue->count; i++)
@@ -0,0 +1,9 @@
+GLOBAL readTimestampCounter
+
+section .text
+
+readTimestampCounter:
+	rdtsc
+	shl rdx, 32
+	or rax, rdx
+	ret
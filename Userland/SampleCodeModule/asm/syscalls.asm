@@ -5,6 +5,7 @@ GLOBAL sys_clearScreen
 GLOBAL sys_millis
 GLOBAL sys_time
 GLOBAL sys_date
+GLOBAL sys_sleep
 GLOBAL sys_malloc
 GLOBAL sys_free
 GLOBAL sys_realloc
@@ -19,6 +20,9 @@ GLOBAL sys_kill
 GLOBAL sys_priority
 GLOBAL sys_listProcesses
 GLOBAL sys_waitpid
+GLOBAL sys_readTrace
+GLOBAL sys_traceStreaming
+GLOBAL sys_realTime
 GLOBAL sys_createPipe
 GLOBAL sys_openPipe
 GLOBAL sys_unlinkPipe
@@ -45,6 +49,7 @@ sys_clearScreen: syscall 0x10
 sys_millis: syscall 0x20
 sys_time: syscall 0x21
 sys_date: syscall 0x22
+sys_sleep: syscall 0x23
 
 sys_malloc: syscall 0x30
 sys_free: syscall 0x31
@@ -61,6 +66,9 @@ sys_kill: syscall 0x46
 sys_priority: syscall 0x47
 sys_listProcesses: syscall 0x48
 sys_waitpid: syscall 0x49
+sys_readTrace: syscall 0x4A
+sys_traceStreaming: syscall 0x4B
+sys_realTime: syscall 0x4C
 
 sys_createPipe: syscall 0x50
 sys_openPipe: syscall 0x51
@@ -1,6 +1,7 @@
 #include <commands.h>
 #include <phylo.h>
 #include <processes.h>
+#include <schedBench.h>
 #include <string.h>
 #include <syscalls.h>
 #include <testUtil.h>
@@ -16,8 +17,12 @@ static Command validCommands[] = {
     {runLoop, "loop", "Creates a process that prints it's PID once every 3 seconds."},
     {runKill, "kill", "Kills the process with the parameter-specified PID."},
     {runPriority, "nice", "Changes the priority of the process with the parameter-specified PID."},
+    {runRealTime, "rt",
+     "Schedules the process with the given PID as real-time, with a period, runtime and deadline in milliseconds."},
     {runBlock, "block", "Blocks the process with the given PID."},
     {runUnblock, "unblock", "Unblocks the process with the given PID."},
+    {runTrace, "trace",
+     "Dumps the latest scheduler events. \"trace serial on\" or \"trace serial off\" toggles streaming them to COM1."},
     {runSem, "sem", "Displays a list of all the currently active semaphores with their properties."},
     {runCat, "cat", "Creates a process that prints the standard input onto the standard output."},
     {runWc, "wc",
@@ -30,6 +35,8 @@ static Command validCommands[] = {
     {runTestProcesses, "testprocesses", "Runs a test for processes."},
     {runTestPrio, "testprio", "Runs a test on process priorities."},
     {runPhylo, "phylo", "Runs the philosopher, add one philosopher with \"a\", remove one philosopher with \"r\"."},
+    {runSchedBench, "schedbench",
+     "Measures yield, semaphore and pipe ping-pong and wakeup latencies in cycles. Optionally receives the sample count."},
 };
 
 const Command *
@@ -95,6 +102,7 @@ runMem(int stdin, int stdout, int stderr, int isForeground, int argc, const char
     fprintf(stdout, "Memory Manager Type: %s\n",
             memoryState.type == LIST    ? "LIST"
             : memoryState.type == BUDDY ? "BUDDY"
+            : memoryState.type == TLSF  ? "TLSF"
                                         : "UNKNOWN");
     fprintf(stdout, "Total memory: %u.\n", memoryState.total);
     fprintf(stdout, "Used: %u (%u%%).\n", memoryState.used, (memoryState.used * 100 / memoryState.total));
@@ -103,22 +111,54 @@ runMem(int stdin, int stdout, int stderr, int isForeground, int argc, const char
     return 1;
 }
 
+static int
+findProcess(Pid pid, ProcessInfo *storingInfo) {
+    ProcessInfo array[PROCESS_PAGE_SIZE];
+    unsigned int cursor = 0;
+    int count;
+
+    while ((count = sys_listProcesses(array, PROCESS_PAGE_SIZE, &cursor)) > 0) {
+        for (int i = 0; i < count; i++) {
+            if (array[i].pid == pid) {
+                *storingInfo = array[i];
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}
+
 int
 runPs(int stdin, int stdout, int stderr, int isForeground, int argc, const char *const argv[], Pid *createdProcess) {
-    ProcessInfo array[MAX_PROCESSES];
-    int count = sys_listProcesses(array, MAX_PROCESSES);
+    ProcessInfo array[PROCESS_PAGE_SIZE];
+    unsigned int cursor = 0;
+    int count;
 
-    for (int i = 0; i < count; i++) {
-        const char *status = array[i].status == READY     ? "READY"
-                             : array[i].status == RUNNING ? "RUNNING"
-                             : array[i].status == BLOCKED ? "BLOCKED"
-                             : array[i].status == KILLED  ? "KILLED"
-                                                          : "UNKNOWN";
-
-        fprintf(stdout,
-                "PID=%d \t Name=%s \t Status=%s \t Priority=%d \t Foreground=%d \t stackEnd=%x \t stackStart=%x \t RSP=%x\n",
-                array[i].pid, array[i].name, status, array[i].priority, array[i].isForeground, array[i].stackEnd,
-                array[i].stackStart, array[i].currentRSP);
+    while ((count = sys_listProcesses(array, PROCESS_PAGE_SIZE, &cursor)) > 0) {
+        unsigned long now = sys_millis();
+
+        for (int i = 0; i < count; i++) {
+            const char *status = array[i].status == READY     ? "READY"
+                                 : array[i].status == RUNNING ? "RUNNING"
+                                 : array[i].status == BLOCKED ? "BLOCKED"
+                                 : array[i].status == KILLED  ? "KILLED"
+                                                              : "UNKNOWN";
+
+            // Share of the CPU over the lifetime of the process
+            unsigned long age = now - array[i].startTime;
+            unsigned int cpuPercentage = age == 0 ? 0 : (unsigned int) (array[i].cpuTime * 100 / age);
+
+            fprintf(stdout,
+                    "PID=%d \t Name=%s \t Status=%s \t Priority=%d \t Foreground=%d \t stackEnd=%x \t stackStart=%x \t RSP=%x\n",
+                    array[i].pid, array[i].name, status, array[i].priority, array[i].isForeground, array[i].stackEnd,
+                    array[i].stackStart, array[i].currentRSP);
+            fprintf(stdout,
+                    "\t CPU=%u%% \t CPUTime=%ums \t WaitTime=%ums \t LastRun=%ums \t Switches=%u voluntary, %u involuntary\n",
+                    cpuPercentage, (unsigned int) array[i].cpuTime, (unsigned int) array[i].waitTime,
+                    (unsigned int) array[i].lastRunTime, (unsigned int) array[i].voluntarySwitches,
+                    (unsigned int) array[i].involuntarySwitches);
+        }
     }
 
     return 1;
@@ -138,18 +178,14 @@ runKill(int stdin, int stdout, int stderr, int isForeground, int argc, const cha
         return 0;
     }
 
-    int result = sys_kill(pidToKill);
+    ProcessInfo info;
+    int found = findProcess(pidToKill, &info);
 
-    ProcessInfo array[MAX_PROCESSES];
-    int count = sys_listProcesses(array, MAX_PROCESSES);
+    int result = sys_kill(pidToKill);
 
-    if (result == 0) {
-        for (int i = 0; i < count; i++) {
-            if (array[i].pid == pidToKill) {
-                fprintf(stdout, "Stoped %s.", array[i].name);
-                return 1;
-            }
-        }
+    if (result == 0 && found) {
+        fprintf(stdout, "Stoped %s.", info.name);
+        return 1;
     }
 
     fprintf(stderr, "kill: (%d) - Error: %d.", pidToKill, result);
@@ -181,6 +217,41 @@ runPriority(int stdin, int stdout, int stderr, int isForeground, int argc, const
     return 1;
 }
 
+int
+runRealTime(int stdin, int stdout, int stderr, int isForeground, int argc, const char *const argv[], Pid *createdProcess) {
+    if (argc == 2 && !strcmp(argv[1], "off")) {
+        Pid pidToChange = atoi(argv[0]);
+        if (sys_realTime(pidToChange, 0, 0, 0) == 0)
+            fprintf(stdout, "%d is no longer real-time.\n", pidToChange);
+        else
+            fprintf(stdout, "rt: (%d) - Error.", pidToChange);
+        return 1;
+    }
+
+    if (argc != 4) {
+        fprint(stderr, "rt: usage: rt [PID] [PERIOD] [RUNTIME] [DEADLINE] or rt [PID] off. Runtime <= deadline <= period.");
+        return 0;
+    }
+
+    Pid pidToChange = atoi(argv[0]);
+    unsigned long period = atoi(argv[1]);
+    unsigned long runtime = atoi(argv[2]);
+    unsigned long deadline = atoi(argv[3]);
+
+    if (period == 0 || runtime == 0 || runtime > deadline || deadline > period) {
+        fprint(stderr, "Invalid parameters. Must be 0 < runtime <= deadline <= period.");
+        return 0;
+    }
+
+    if (sys_realTime(pidToChange, period, runtime, deadline) == 0)
+        fprintf(stdout, "%d is now real-time: %d ms every %d ms, within %d ms.\n", pidToChange, (int) runtime, (int) period,
+                (int) deadline);
+    else
+        fprintf(stdout, "rt: (%d) - Rejected, the real-time processes would not meet their deadlines.", pidToChange);
+
+    return 1;
+}
+
 int
 runBlock(int stdin, int stdout, int stderr, int isForeground, int argc, const char *const argv[], Pid *createdProcess) {
     if (argc != 1) {
@@ -230,6 +301,41 @@ runUnblock(int stdin, int stdout, int stderr, int isForeground, int argc, const
     return 0;
 }
 
+int
+runTrace(int stdin, int stdout, int stderr, int isForeground, int argc, const char *const argv[], Pid *createdProcess) {
+    static const char *eventNames[] = {"switch-out", "switch-in", "block", "unblock", "force-run", "create", "kill", "hand-off"};
+
+    if (argc == 2 && !strcmp(argv[0], "serial") && (!strcmp(argv[1], "on") || !strcmp(argv[1], "off"))) {
+        int enabled = !strcmp(argv[1], "on");
+        sys_traceStreaming(enabled);
+        fprintf(stdout, "Scheduler trace streaming %s.", enabled ? "enabled" : "disabled");
+        return 1;
+    }
+
+    if (argc != 0) {
+        fprint(stderr, "trace: usage: trace [serial on|off]");
+        return 0;
+    }
+
+    TraceEvent array[TRACE_PAGE_SIZE];
+    unsigned long cursor = 0;
+    uint64_t previousTimestamp = 0;
+    int count, total = 0;
+
+    // Printing produces new events, so stop after one buffer worth of them.
+    fprint(stdout, "Cycles since previous event, event, PID, other:");
+    while (total < TRACE_BUFFER_SIZE && (count = sys_readTrace(array, TRACE_PAGE_SIZE, &cursor)) > 0) {
+        for (int i = 0; i < count; i++) {
+            unsigned int delta = previousTimestamp == 0 ? 0 : (unsigned int) (array[i].timestamp - previousTimestamp);
+            previousTimestamp = array[i].timestamp;
+            fprintf(stdout, "\n+%u \t %s \t %d \t %d", delta, eventNames[array[i].type], array[i].pid, array[i].other);
+        }
+        total += count;
+    }
+
+    return 1;
+}
+
 int
 runSem(int stdin, int stdout, int stderr, int isForeground, int argc, const char *const argv[], Pid *createdProcess) {
     SemaphoreInfo array[16];
@@ -384,6 +490,19 @@ runTestPrio(int stdin, int stdout, int stderr, int isForeground, int argc, const
     return *createdProcess >= 0;
 }
 
+int
+runSchedBench(int stdin, int stdout, int stderr, int isForeground, int argc, const char *const argv[], Pid *createdProcess) {
+    ProcessCreateInfo pci = {.name = "schedBench",
+                             .start = schedBench,
+                             .isForeground = isForeground,
+                             .priority = PRIORITY_DEFAULT,
+                             .argc = argc,
+                             .argv = argv};
+
+    *createdProcess = sys_createProcess(stdin, stdout, stderr, &pci);
+    return *createdProcess >= 0;
+}
+
 int
 runPhylo(int stdin, int stdout, int stderr, int isForeground, int argc, const char *const argv[], Pid *createdProcess) {
     ProcessCreateInfo pci = {.name = "phylo",
@@ -19,8 +19,10 @@ int runPs(int stdin, int stdout, int stderr, int isForeground, int argc, const c
 int runLoop(int stdin, int stdout, int stderr, int isForeground, int argc, const char *const argv[], Pid *createdProcess);
 int runKill(int stdin, int stdout, int stderr, int isForeground, int argc, const char *const argv[], Pid *createdProcess);
 int runPriority(int stdin, int stdout, int stderr, int isForeground, int argc, const char *const argv[], Pid *createdProcess);
+int runRealTime(int stdin, int stdout, int stderr, int isForeground, int argc, const char *const argv[], Pid *createdProcess);
 int runBlock(int stdin, int stdout, int stderr, int isForeground, int argc, const char *const argv[], Pid *createdProcess);
 int runUnblock(int stdin, int stdout, int stderr, int isForeground, int argc, const char *const argv[], Pid *createdProcess);
+int runTrace(int stdin, int stdout, int stderr, int isForeground, int argc, const char *const argv[], Pid *createdProcess);
 
 /* Process synchronization commands */
 int runSem(int stdin, int stdout, int stderr, int isForeground, int argc, const char *const argv[], Pid *createdProcess);
@@ -38,5 +40,6 @@ int runTestSync(int stdin, int stdout, int stderr, int isForeground, int argc, c
 int runTestProcesses(int stdin, int stdout, int stderr, int isForeground, int argc, const char *const argv[],
                      Pid *createdProcess);
 int runTestPrio(int stdin, int stdout, int stderr, int isForeground, int argc, const char *const argv[], Pid *createdProcess);
+int runSchedBench(int stdin, int stdout, int stderr, int isForeground, int argc, const char *const argv[], Pid *createdProcess);
 
 #endif
\ No newline at end of file
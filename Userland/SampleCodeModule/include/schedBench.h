@@ -0,0 +1,25 @@
+#ifndef __SCHED_BENCH_H__
+#define __SCHED_BENCH_H__
+
+/* Local headers */
+#include <defs.h>
+
+/* Constants */
+#define SCHEDBENCH_DEFAULT_SAMPLES 1000
+#define SCHEDBENCH_MAX_SAMPLES     4096
+#define SCHEDBENCH_WARMUP          16
+
+#define SCHEDBENCH_PING "schedBenchPing"
+#define SCHEDBENCH_PONG "schedBenchPong"
+
+// The woken process must run ahead of the benchmark to measure the wakeup path and not a whole quantum.
+#define SCHEDBENCH_WAKEE_PRIORITY PRIORITY_IMPORTANT
+
+/**
+ * @brief Measures scheduler and IPC latencies in TSC cycles and prints one line per benchmark:
+ * "schedbench <name> samples=<n> min=<cycles> median=<cycles> p99=<cycles>".
+ * Receives the amount of samples per benchmark as optional argument.
+ */
+void schedBench(int argc, char *argv[]);
+
+#endif
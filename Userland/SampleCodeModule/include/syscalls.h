@@ -12,6 +12,7 @@ void sys_clearScreen();
 unsigned long sys_millis();
 void sys_time(char *buffer);
 void sys_date(char *buffer);
+int sys_sleep(unsigned long millis);
 
 void *sys_malloc(size_t size);
 int sys_free(void *ptr);
@@ -26,8 +27,11 @@ int sys_unblock(Pid pid);
 void sys_yield();
 int sys_kill(Pid pid);
 int sys_priority(Pid pid, Priority newPriority);
-int sys_listProcesses(ProcessInfo *array, int maxProcesses);
+int sys_listProcesses(ProcessInfo *array, int maxProcesses, unsigned int *cursor);
 int sys_waitpid(Pid pid);
+int sys_readTrace(TraceEvent *array, int maxEvents, unsigned long *cursor);
+int sys_traceStreaming(int enabled);
+int sys_realTime(Pid pid, unsigned long period, unsigned long runtime, unsigned long deadline);
 
 int sys_createPipe(int pipefd[2]);
 int sys_openPipe(const char *name, int pipefd[2]);
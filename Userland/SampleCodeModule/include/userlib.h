@@ -69,4 +69,9 @@ int getLine(char *buffer, int maxSize);
  */
 int fgetLine(int fd, char *buffer, int maxSize);
 
+/**
+ * @brief Reads the CPU's time stamp counter (RDTSC), which counts cycles at a constant rate.
+ */
+uint64_t readTimestampCounter();
+
 #endif
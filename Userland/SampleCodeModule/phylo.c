@@ -58,7 +58,8 @@ getSleepingTime() {
 void
 startPhylo(int argc, char *argv[]) {
 
-    maxPhilosophers = getMaxAvailableProcesses();
+    unsigned int availableProcesses = getMaxAvailableProcesses();
+    maxPhilosophers = availableProcesses < MAX_PHYLOSOPHERS ? availableProcesses : MAX_PHYLOSOPHERS;
     if (maxPhilosophers < MIN_PHYLOSOPHERS) {
         fprintf(STDERR, "phylo: (%d) - Error: Phylo requires a minimum of 6 available processes.\n", sys_getpid());
         return;
@@ -0,0 +1,233 @@
+#include <defs.h>
+#include <schedBench.h>
+#include <string.h>
+#include <syscalls.h>
+#include <userlib.h>
+
+static uint64_t samples[SCHEDBENCH_MAX_SAMPLES];
+
+// Shared with the wakee process, which lives in the same address space
+static volatile uint64_t wakeupStart;
+static volatile uint64_t wakeupEnd;
+
+static void
+sortSamples(int count) {
+    for (int i = 1; i < count; i++) {
+        uint64_t value = samples[i];
+        int j = i - 1;
+        for (; j >= 0 && samples[j] > value; j--)
+            samples[j + 1] = samples[j];
+        samples[j + 1] = value;
+    }
+}
+
+static unsigned int
+toCycles(uint64_t value) {
+    return value > 0xFFFFFFFF ? 0xFFFFFFFF : (unsigned int) value;
+}
+
+static void
+report(const char *name, int count) {
+    if (count <= 0) {
+        fprintf(STDERR, "schedbench %s failed\n", name);
+        return;
+    }
+
+    sortSamples(count);
+    printf("schedbench %s samples=%d min=%u median=%u p99=%u\n", name, count, toCycles(samples[0]),
+           toCycles(samples[count / 2]), toCycles(samples[(count * 99) / 100]));
+}
+
+static Pid
+createHelper(const char *name, ProcessStart start, Priority priority, int stdin, int stdout) {
+    ProcessCreateInfo pci = {.name = name, .start = start, .isForeground = 0, .priority = priority, .argc = 0, .argv = NULL};
+    return sys_createProcess(stdin, stdout, STDERR, &pci);
+}
+
+static void
+stopHelper(Pid pid) {
+    sys_kill(pid);
+    sys_waitpid(pid);
+}
+
+static int
+benchYield(int count) {
+    for (int i = -SCHEDBENCH_WARMUP; i < count; i++) {
+        uint64_t start = readTimestampCounter();
+        sys_yield();
+        uint64_t end = readTimestampCounter();
+        if (i >= 0)
+            samples[i] = end - start;
+    }
+
+    return count;
+}
+
+static void
+semaphorePartner(int argc, char *argv[]) {
+    Sem ping = sys_openSem(SCHEDBENCH_PING, 0);
+    Sem pong = sys_openSem(SCHEDBENCH_PONG, 0);
+
+    while (1) {
+        sys_wait(ping);
+        sys_post(pong);
+    }
+}
+
+static int
+benchSemaphore(int count) {
+    Sem ping = sys_openSem(SCHEDBENCH_PING, 0);
+    Sem pong = sys_openSem(SCHEDBENCH_PONG, 0);
+    Pid partner;
+
+    if (ping < 0 || pong < 0 || (partner = createHelper("schedBenchSem", semaphorePartner, PRIORITY_DEFAULT, -1, -1)) < 0) {
+        sys_closeSem(ping);
+        sys_closeSem(pong);
+        return -1;
+    }
+
+    for (int i = -SCHEDBENCH_WARMUP; i < count; i++) {
+        uint64_t start = readTimestampCounter();
+        sys_post(ping);
+        sys_wait(pong);
+        uint64_t end = readTimestampCounter();
+        if (i >= 0)
+            samples[i] = end - start;
+    }
+
+    stopHelper(partner);
+    sys_closeSem(ping);
+    sys_closeSem(pong);
+    return count;
+}
+
+static void
+pipePartner(int argc, char *argv[]) {
+    char c;
+    while (sys_read(STDIN, &c, 1) == 1)
+        sys_write(STDOUT, &c, 1);
+}
+
+static int
+benchPipe(int count) {
+    int ping[2], pong[2];
+    if (sys_createPipe(ping) < 0)
+        return -1;
+
+    if (sys_createPipe(pong) < 0) {
+        sys_close(ping[0]);
+        sys_close(ping[1]);
+        return -1;
+    }
+
+    Pid partner = createHelper("schedBenchPipe", pipePartner, PRIORITY_DEFAULT, ping[0], pong[1]);
+    sys_close(ping[0]);
+    sys_close(pong[1]);
+
+    int result = count;
+    char c = 'x';
+    for (int i = -SCHEDBENCH_WARMUP; i < count && partner >= 0; i++) {
+        uint64_t start = readTimestampCounter();
+        if (sys_write(ping[1], &c, 1) != 1 || sys_read(pong[0], &c, 1) != 1) {
+            result = -1;
+            break;
+        }
+        uint64_t end = readTimestampCounter();
+        if (i >= 0)
+            samples[i] = end - start;
+    }
+
+    if (partner < 0)
+        result = -1;
+    else
+        stopHelper(partner);
+
+    sys_close(ping[1]);
+    sys_close(pong[0]);
+    return result;
+}
+
+static void
+wakee(int argc, char *argv[]) {
+    Pid pid = sys_getpid();
+
+    while (1) {
+        sys_block(pid);
+        wakeupEnd = readTimestampCounter();
+    }
+}
+
+static int
+getProcessStatus(Pid pid, ProcessStatus *status) {
+    ProcessInfo array[PROCESS_PAGE_SIZE];
+    unsigned int cursor = 0;
+    int count;
+
+    while ((count = sys_listProcesses(array, PROCESS_PAGE_SIZE, &cursor)) > 0) {
+        for (int i = 0; i < count; i++) {
+            if (array[i].pid == pid) {
+                *status = array[i].status;
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+// Waits for a process to be blocked, as unblocking one that has not blocked yet would lose the wakeup.
+static int
+waitUntilBlocked(Pid pid) {
+    ProcessStatus status;
+    while (getProcessStatus(pid, &status) && status != KILLED) {
+        if (status == BLOCKED)
+            return 1;
+        sys_yield();
+    }
+
+    return 0;
+}
+
+static int
+benchWakeup(int count) {
+    Pid partner = createHelper("schedBenchWakee", wakee, SCHEDBENCH_WAKEE_PRIORITY, -1, -1);
+    if (partner < 0)
+        return -1;
+
+    for (int i = -SCHEDBENCH_WARMUP; i < count; i++) {
+        if (!waitUntilBlocked(partner)) {
+            count = -1;
+            break;
+        }
+
+        wakeupStart = readTimestampCounter();
+        sys_unblock(partner);
+
+        // The wakee takes its timestamp before blocking again.
+        if (!waitUntilBlocked(partner)) {
+            count = -1;
+            break;
+        }
+
+        if (i >= 0)
+            samples[i] = wakeupEnd - wakeupStart;
+    }
+
+    stopHelper(partner);
+    return count;
+}
+
+void
+schedBench(int argc, char *argv[]) {
+    int count = SCHEDBENCH_DEFAULT_SAMPLES;
+    if (argc > 0 && ((count = atoi(argv[0])) <= 0 || count > SCHEDBENCH_MAX_SAMPLES)) {
+        fprintf(STDERR, "schedbench: usage: schedbench [SAMPLES]. Samples must be between 1 and %d.\n", SCHEDBENCH_MAX_SAMPLES);
+        return;
+    }
+
+    printf("# schedbench: latencies in TSC cycles\n");
+    report("yield", benchYield(count));
+    report("sem-pingpong", benchSemaphore(count));
+    report("pipe-pingpong", benchPipe(count));
+    report("unblock-wakeup", benchWakeup(count));
+}
@@ -56,8 +56,21 @@ testMM(int argc, char *argv[]) {
                     return;
                 }
 
+        // Reallocating to 0 must free the block, whatever the memory manager
+        if (rq > 0) {
+            MemoryState before, after;
+            sys_memoryState(&before);
+            void *result = sys_realloc(mm_rqs[0].address, 0);
+            sys_memoryState(&after);
+
+            if (result != NULL || after.used >= before.used || sys_free(mm_rqs[0].address) == 0) {
+                printf("test_mm ERROR: realloc to 0 did not free the block\n");
+                return;
+            }
+        }
+
         // Free
-        for (i = 0; i < rq; i++)
+        for (i = 1; i < rq; i++)
             if (mm_rqs[i].address)
                 sys_free(mm_rqs[i].address);
     }
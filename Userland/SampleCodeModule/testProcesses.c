@@ -2,6 +2,8 @@
 #include <testUtil.h>
 #include <userlib.h>
 
+#define MAX_TEST_PROCESSES 32
+
 enum State { RUNNING_TEST, BLOCKED_TEST, KILLED_TEST };
 
 typedef struct P_rq {
@@ -17,6 +19,9 @@ testProcesses(int argc, char *argv[]) {
     uint64_t max_processes = getMaxAvailableProcesses();
     char *argvAux[] = {0};
 
+    if (max_processes > MAX_TEST_PROCESSES)
+        max_processes = MAX_TEST_PROCESSES;
+
     p_rq p_rqs[max_processes];
 
     while (1) {
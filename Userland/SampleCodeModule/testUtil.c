@@ -25,10 +25,15 @@ endlessLoopPrint(int argc, char *argv[]) {
     }
 }
 
-uint8_t
+unsigned int
 getMaxAvailableProcesses() {
-    ProcessInfo array[MAX_PROCESSES];
-    int count = sys_listProcesses(array, MAX_PROCESSES);
+    ProcessInfo array[PROCESS_PAGE_SIZE];
+    unsigned int cursor = 0;
+    unsigned int count = 0;
+    int pageCount;
+
+    while ((pageCount = sys_listProcesses(array, PROCESS_PAGE_SIZE, &cursor)) > 0)
+        count += pageCount;
 
     return MAX_PROCESSES - count;
 }
@@ -73,10 +73,7 @@ satoi(char *str) {
 
 void
 sleep(unsigned long millis) {
-    unsigned long start = sys_millis();
-    do {
-        sys_yield();
-    } while (sys_millis() - start < millis);
+    sys_sleep(millis);
 }
 
 int
@@ -1,14 +1,25 @@
 #!/bin/bash
-if [ "$1" == "buddy" ]; then
-    MM="USE_BUDDY"
-else
-    MM=""
-fi
+MM=""
+SCHED=""
+HZ=""
+for arg in "$@"; do
+    if [ "$arg" == "buddy" ]; then
+        MM="USE_BUDDY"
+    elif [ "$arg" == "tlsf" ]; then
+        MM="USE_TLSF"
+    elif [ "$arg" == "cfs" ]; then
+        SCHED="USE_CFS"
+    elif [ "$arg" == "mlfq" ]; then
+        SCHED="USE_MLFQ"
+    elif [[ "$arg" == hz=* ]]; then
+        HZ="${arg#hz=}"
+    fi
+done
 
 docker run -d -v ${PWD}:/root --security-opt seccomp:unconfined -ti --name dockerSO agodio/itba-so:1.0
 docker exec -it dockerSO make clean -C /root/Toolchain
-docker exec -it dockerSO make all -C /root/Toolchain MM="$MM"
+docker exec -it dockerSO make all -C /root/Toolchain MM="$MM" SCHED="$SCHED" HZ="$HZ"
 docker exec -it dockerSO make clean -C /root/
-docker exec -it dockerSO make all -C /root/ MM="$MM"
+docker exec -it dockerSO make all -C /root/ MM="$MM" SCHED="$SCHED" HZ="$HZ"
 docker stop dockerSO
 docker rm dockerSO
\ No newline at end of file